@@ -54,8 +54,9 @@ public:
 
 class Layer {
 public:
-    std::shared_ptr<olc::Sprite> background;
-    std::shared_ptr<olc::Sprite> walk_mask;
+    // Mostly uniform or transparent, so kept as tiles
+    std::shared_ptr<olc::TiledSprite> background;
+    std::shared_ptr<olc::TiledSprite> walk_mask;
     std::shared_ptr<olc::Sprite> light_mask;
 
     std::list<Collectible> collectibles;
@@ -74,6 +75,9 @@ public:
     std::shared_ptr<olc::Sprite> player;
     float pos_x;
     float pos_y;
+    // Position at the start of the last tick, frames are drawn in between
+    float prev_x = 0;
+    float prev_y = 0;
     int layer;
     float time_remaining;
 
@@ -82,10 +86,41 @@ public:
     int viewport_y;
 
 public:
-    void update_viewport(uint32_t screen_width, uint32_t screen_height)
+    // Pre-flattened copies of layers 0..n, indexed by n and built on demand.
+    // Only the topmost cached_composites stacks are kept, lower ones are
+    // composited live every frame.
+    std::vector<std::shared_ptr<olc::Sprite>> composites;
+    int cached_composites = 0;
+
+    bool is_composite_cached(int layer)
+    {
+        return layer >= (int)layers.size() - cached_composites;
+    }
+
+    // Call whenever the background of a layer changes, every stack that
+    // includes that layer is rebuilt the next time it is drawn
+    void invalidate_composites(int from_layer = 0)
+    {
+        for (int i = from_layer; i < (int)composites.size(); i++) {
+            composites[i].reset();
+        }
+    }
+
+public:
+    float draw_x(float alpha) const
+    {
+        return prev_x + (pos_x - prev_x) * alpha;
+    }
+
+    float draw_y(float alpha) const
+    {
+        return prev_y + (pos_y - prev_y) * alpha;
+    }
+
+    void update_viewport(uint32_t screen_width, uint32_t screen_height, float alpha = 1.0f)
     {
-        int pos_x = std::round(this->pos_x);
-        int pos_y = std::round(this->pos_y);
+        int pos_x = std::round(draw_x(alpha));
+        int pos_y = std::round(draw_y(alpha));
 
         int offset_x = screen_width / 2;
         int offset_y = screen_height / 2;
@@ -117,6 +152,8 @@ public:
     static const uint8_t GS_LICENSE = 9;
 
     uint8_t game_state = 0;
+    // State the last tick asked for, picked up when the frame is drawn
+    uint8_t tick_state = 0;
     float timer = 0;
 
     std::unique_ptr<World> world = nullptr;
@@ -124,10 +161,23 @@ public:
     float acc_y = 0;
     int option = 0;
 
+    // Menus only redraw what changed, the screen keeps everything else
+    bool partial_redraw = true;
+    bool redraw = true;
+    bool dirty_overlay = false;
+    // Nothing moves faster than the display can show, so don't draw faster either
+    float frame_rate_limit = 60.0f;
+    // The world moves in fixed steps so it plays the same at any frame rate
+    float tick_rate = 120.0f;
+
     void update_state(uint8_t new_state)
     {
         if (game_state != new_state) {
+            // Every other state draws over the world
+            InvalidateScrollingBackground();
+            redraw = true;
             game_state = new_state;
+            tick_state = new_state;
             timer = 0;
             acc_x = 0;
             acc_y = 0;
@@ -138,6 +188,14 @@ public:
 public:
     std::vector<std::string> license_text;
 
+    // HUD text, only re-rendered when the value it shows changes
+    std::vector<std::shared_ptr<olc::TextLabel>> score_labels;
+    std::vector<int64_t> score_values;
+    olc::TextLabel time_label;
+    int64_t time_value = -1;
+    olc::TextLabel coords_label;
+    int64_t coords_value = -1;
+
 public:
 	Outdoors()
 	{
@@ -147,10 +205,21 @@ public:
 public:
 	bool OnUserCreate() override
 	{
+        EnableDirtyRects(partial_redraw);
+        SetFrameRateLimit(frame_rate_limit);
+        SetFixedUpdateRate(tick_rate);
 		return true;
 	}
 
-	bool OnUserUpdate(float fElapsedTime) override
+	bool OnUserFixedUpdate(float fTickTime) override
+	{
+        if (game_state == GS_MAIN && tick_state == GS_MAIN) {
+            tick_state = main_tick(fTickTime);
+        }
+		return true;
+	}
+
+	bool OnUserRender(float fElapsedTime, float fAlpha) override
 	{
         uint8_t next_state;
         switch (game_state) {
@@ -164,7 +233,7 @@ public:
                 next_state = title();
                 break;
             case GS_MAIN:
-                next_state = main(fElapsedTime);
+                next_state = main(fAlpha);
                 break;
             case GS_WON:
                 next_state = won();
@@ -185,6 +254,13 @@ public:
                 break;
         }
 
+#ifndef NDEBUG
+        if (GetKey(olc::F3).bPressed) {
+            dirty_overlay = !dirty_overlay;
+            SetDirtyRectOverlay(dirty_overlay);
+        }
+#endif
+
         timer += fElapsedTime;
 
         update_state(next_state);
@@ -231,6 +307,7 @@ public:
             if (olc::OK != world->player->LoadFromFile("guy.png")) {
                 failed.push_back("guy.png");
             }
+            world->player->Premultiply();
 
             std::shared_ptr<CollectibleType> egg_type = std::make_shared<CollectibleType>();
             egg_type->name = "Eggs";
@@ -239,17 +316,18 @@ public:
             if (olc::OK != egg_type->sprite->LoadFromFile("egg.png")) {
                 failed.push_back("egg.png");
             }
+            egg_type->sprite->Premultiply();
             world->collectible_types.push_back(egg_type);
 
             // Layer 0
             {
                 Layer layer;
-                layer.background = std::make_shared<olc::Sprite>();
+                layer.background = std::make_shared<olc::TiledSprite>();
                 ;
                 if (olc::OK != layer.background->LoadFromFile("layers/background-1.png")) {
                     failed.push_back("layers/background-1.png");
                 }
-                layer.walk_mask = std::make_shared<olc::Sprite>();
+                layer.walk_mask = std::make_shared<olc::TiledSprite>();
                 if (olc::OK != layer.walk_mask->LoadFromFile("layers/walk-1.png")) {
                     failed.push_back("layers/walk-1.png");
                 }
@@ -280,11 +358,11 @@ public:
             // Layer 1
             {
                 Layer layer;
-                layer.background = std::make_shared<olc::Sprite>();
+                layer.background = std::make_shared<olc::TiledSprite>();
                 if (olc::OK != layer.background->LoadFromFile("layers/background-2.png")) {
                     failed.push_back("layers/background-2.png");
                 }
-                layer.walk_mask = std::make_shared<olc::Sprite>();
+                layer.walk_mask = std::make_shared<olc::TiledSprite>();
                 if (olc::OK != layer.walk_mask->LoadFromFile("layers/walk-2.png")) {
                     failed.push_back("layers/walk-2.png");
                 }
@@ -311,12 +389,12 @@ public:
             // Layer 2
             {
                 Layer layer;
-                layer.background = std::make_shared<olc::Sprite>();
+                layer.background = std::make_shared<olc::TiledSprite>();
                 ;
                 if (olc::OK != layer.background->LoadFromFile("layers/background-3.png")) {
                     failed.push_back("layers/background-3.png");
                 }
-                layer.walk_mask = std::make_shared<olc::Sprite>();
+                layer.walk_mask = std::make_shared<olc::TiledSprite>();
                 if (olc::OK != layer.walk_mask->LoadFromFile("layers/walk-3.png")) {
                     failed.push_back("layers/walk-3.png");
                 }
@@ -344,11 +422,11 @@ public:
             // Layer 3
             {
                 Layer layer;
-                layer.background = std::make_shared<olc::Sprite>();
+                layer.background = std::make_shared<olc::TiledSprite>();
                 if (olc::OK != layer.background->LoadFromFile("layers/background-4.png")) {
                     failed.push_back("layers/background-4.png");
                 }
-                layer.walk_mask = std::make_shared<olc::Sprite>();
+                layer.walk_mask = std::make_shared<olc::TiledSprite>();
                 if (olc::OK != layer.walk_mask->LoadFromFile("layers/walk-4.png")) {
                     failed.push_back("layers/walk-4.png");
                 }
@@ -367,6 +445,10 @@ public:
                 world->layers.push_back(layer);
             }
 
+            // Each stack costs one world sized sprite, cache all of them
+            world->composites.resize(world->layers.size());
+            world->cached_composites = world->layers.size();
+
             if (1 != failed.size()) {
                 Clear(olc::BLACK);
                 for (int i = 0; i < failed.size(); i++) {
@@ -434,6 +516,8 @@ public:
             world->layer = 1;
             world->pos_x = 571;
             world->pos_y = 459;
+            world->prev_x = world->pos_x;
+            world->prev_y = world->pos_y;
             world->update_viewport(ScreenWidth(), ScreenHeight());
             for (auto &layer: world->layers) {
                 for (auto &egg: layer.collectibles) {
@@ -455,6 +539,7 @@ public:
                     return GS_EXIT;
             }
         }
+        int last_option = option;
         if (GetKey(olc::UP).bPressed || GetKey(olc::W).bPressed || GetKey(olc::K).bPressed) {
             option--;
         }
@@ -466,16 +551,59 @@ public:
         if (timer > 30 || GetKey(olc::ESCAPE).bPressed) {
             return GS_SLEEP;
         }
-        Clear(olc::BLACK);
-        DrawString(ScreenWidth() / 2 - 5 * 16 - 8, ScreenHeight() / 4 - 8, "PaintedEggs", olc::WHITE, 2);
-        DrawString(ScreenWidth() / 2 - 2 * 8 - 4, ScreenHeight() / 2 - 4, "Start");
-        DrawString(ScreenWidth() / 2 - 2 * 8 - 4, ScreenHeight() / 2 + 4, "License");
-        DrawString(ScreenWidth() / 2 - 2 * 8 - 4, ScreenHeight() / 2 + 8 + 4, "Exit");
-        DrawString(ScreenWidth() / 2 - 4 * 8 - 4, ScreenHeight() / 2 - 4 + option * 8, "*");
+        if (redraw || !partial_redraw) {
+            Clear(olc::BLACK);
+            DrawString(ScreenWidth() / 2 - 5 * 16 - 8, ScreenHeight() / 4 - 8, "PaintedEggs", olc::WHITE, 2);
+            DrawString(ScreenWidth() / 2 - 2 * 8 - 4, ScreenHeight() / 2 - 4, "Start");
+            DrawString(ScreenWidth() / 2 - 2 * 8 - 4, ScreenHeight() / 2 + 4, "License");
+            DrawString(ScreenWidth() / 2 - 2 * 8 - 4, ScreenHeight() / 2 + 8 + 4, "Exit");
+            DrawString(ScreenWidth() / 2 - 4 * 8 - 4, ScreenHeight() / 2 - 4 + option * 8, "*");
+            redraw = false;
+        } else if (option != last_option) {
+            FillRect(ScreenWidth() / 2 - 4 * 8 - 4, ScreenHeight() / 2 - 4, 8, 3 * 8, olc::BLACK);
+            DrawString(ScreenWidth() / 2 - 4 * 8 - 4, ScreenHeight() / 2 - 4 + option * 8, "*");
+        }
 
         return GS_TITLE;
     }
 
+    olc::Sprite *layer_composite(int layer)
+    {
+        if (!world->is_composite_cached(layer)) {
+            return nullptr;
+        }
+
+        auto &composite = world->composites[layer];
+        if (!composite) {
+            composite = std::make_shared<olc::Sprite>(world->width, world->height);
+            InvalidateScrollingBackground();
+
+            olc::Pixel::Mode mode = GetPixelMode();
+            SetDrawTarget(composite.get());
+            SetPixelMode(olc::Pixel::MASK);
+            for (int i = 0; i <= layer; i++) {
+                DrawSprite(0, 0, world->layers[i].background.get());
+            }
+            SetPixelMode(mode);
+            SetDrawTarget(nullptr);
+        }
+
+        return composite.get();
+    }
+
+    // Things drawn over the scrolling world have to be put back before it scrolls
+    void draw_overlay_sprite(int x, int y, olc::Sprite *sprite)
+    {
+        DrawSprite(x, y, sprite);
+        AddScrollingOverlay(x, y, sprite->width, sprite->height);
+    }
+
+    void draw_overlay_label(int x, int y, olc::TextLabel *label)
+    {
+        DrawTextLabel(x, y, label);
+        AddScrollingOverlay(x, y, label->width, label->height);
+    }
+
     void step(Direction dir)
     {
         int coord_adj[2][3];
@@ -540,14 +668,13 @@ public:
         }
     }
 
-	uint8_t main(float fElapsedTime)
+	uint8_t main_tick(float fTickTime)
     {
-        if (GetKey(olc::ESCAPE).bPressed) {
-            return GS_PAUSE;
-        }
+        world->prev_x = world->pos_x;
+        world->prev_y = world->pos_y;
 
         const float PLAYER_SPEED = 60;
-        const float STEP = PLAYER_SPEED * fElapsedTime;
+        const float STEP = PLAYER_SPEED * fTickTime;
 
         // 1. Move Player
         if (GetKey(olc::UP).bHeld || GetKey(olc::W).bHeld || GetKey(olc::K).bHeld) {
@@ -607,7 +734,7 @@ public:
         }
         if (!is_won) {
             // 4. Update time
-            world->time_remaining -= fElapsedTime;
+            world->time_remaining -= fTickTime;
 
             // 5. Check for loss
             if (0 >= world->time_remaining) {
@@ -617,34 +744,70 @@ public:
             // 5. Update Collectibles
         }
 
+        if (is_won) {
+            return GS_WON;
+        } else {
+            return GS_MAIN;
+        }
+    }
+
+	uint8_t main(float fAlpha)
+    {
+        // Menus are frame-driven, so pausing is too, or the key that resumed
+        // could reach the next tick as well
+        if (GetKey(olc::ESCAPE).bPressed) {
+            return GS_PAUSE;
+        }
 
         // 6. Render World
-        Clear(olc::BLACK);
-        world->update_viewport(ScreenWidth(), ScreenHeight());
-        SetPixelMode(olc::Pixel::MASK);
-        for (int i = 0; i <= world->layer; i++) {
-            DrawPartialSprite(0, 0, world->layers[i].background.get(), world->viewport_x, world->viewport_y, ScreenWidth(), ScreenHeight());
+        world->update_viewport(ScreenWidth(), ScreenHeight(), fAlpha);
+        olc::Sprite *composite = layer_composite(world->layer);
+        if (composite) {
+            DrawScrollingBackground(composite, world->viewport_x, world->viewport_y);
+        } else {
+            InvalidateScrollingBackground();
+            Clear(olc::BLACK);
+            SetPixelMode(olc::Pixel::MASK);
+            for (int i = 0; i <= world->layer; i++) {
+                DrawPartialSprite(0, 0, world->layers[i].background.get(), world->viewport_x, world->viewport_y, ScreenWidth(), ScreenHeight());
+            }
         }
+        SetPixelMode(olc::Pixel::PREMUL);
         for (auto collectible : world->layers[world->layer].collectibles) {
             if (!collectible.collected && collectible.visible) {
-                DrawSprite(collectible.pos_x - world->viewport_x, collectible.pos_y - world->viewport_y, collectible.type->sprite.get());
+                draw_overlay_sprite(collectible.pos_x - world->viewport_x, collectible.pos_y - world->viewport_y, collectible.type->sprite.get());
             }
         }
-        DrawSprite(world->pos_x - world->viewport_x - 8, world->pos_y - world->viewport_y - 16, world->player.get());
+        int player_x = std::round(world->draw_x(fAlpha));
+        int player_y = std::round(world->draw_y(fAlpha));
+        draw_overlay_sprite(player_x - world->viewport_x - 8, player_y - world->viewport_y - 16, world->player.get());
 
         SetPixelMode(olc::Pixel::NORMAL);
 
         // Draw score
         {
+            if (score_labels.size() != world->collectible_types.size()) {
+                score_labels.clear();
+                for (size_t i = 0; i < world->collectible_types.size(); i++) {
+                    score_labels.push_back(std::make_shared<olc::TextLabel>());
+                }
+                score_values.assign(world->collectible_types.size(), -1);
+            }
+
             int line = 0;
-            for (auto type: world->collectible_types) {
+            for (size_t i = 0; i < world->collectible_types.size(); i++) {
+                auto &type = world->collectible_types[i];
                 if (0 < type->goal) {
-                    std::stringstream ss;
-                    ss << std::setw(4) << std::right << type->collected
-                        << std::setw(0) << std::left << "/"
-                        << std::setw(4) << std::right << type->goal
-                        << std::setw(0) << std::left << " " << type->name;
-                    DrawString(4, line * 8 + 4, ss.str());
+                    if (score_values[i] != type->collected) {
+                        std::stringstream ss;
+                        ss << std::setw(4) << std::right << type->collected
+                            << std::setw(0) << std::left << "/"
+                            << std::setw(4) << std::right << type->goal
+                            << std::setw(0) << std::left << " " << type->name;
+                        UpdateTextLabel(score_labels[i].get(), ss.str());
+                        score_values[i] = type->collected;
+                    }
+                    draw_overlay_label(4, line * 8 + 4, score_labels[i].get());
                     line++;
                 }
             }
@@ -652,38 +815,46 @@ public:
 
         // Draw Time
         {
-            std::stringstream ss;
-            int min = world->time_remaining / 60;
-            int sec = world->time_remaining - min * 60;
-
-            ss << std::setfill('0')
-                << std::setw(2) << std::right << min
-                << std::setw(0) << std::left << ":"
-                << std::setw(2) << std::right << sec;
+            int seconds = world->time_remaining;
+            if (time_value != seconds) {
+                std::stringstream ss;
+                int min = seconds / 60;
+                int sec = seconds - min * 60;
+
+                ss << std::setfill('0')
+                    << std::setw(2) << std::right << min
+                    << std::setw(0) << std::left << ":"
+                    << std::setw(2) << std::right << sec;
+
+                UpdateTextLabel(&time_label, ss.str());
+                time_value = seconds;
+            }
 
-            DrawString(ScreenWidth() - 4 - ss.str().length() * 8, 4, ss.str());
+            draw_overlay_label(ScreenWidth() - 4 - time_label.width, 4, &time_label);
         }
 
 #ifndef NDEBUG
         // Draw coords
         {
-            std::stringstream ss;
-            ss << std::right << "("
-                << std::setw(4) << std::to_string((int) world->pos_x)
-                << std::setw(0) << ", "
-                << std::setw(4) << std::to_string((int)world->pos_y)
-                << std::setw(0) << ")"
-                << std::endl;
+            int64_t coords = (int64_t)(int) world->pos_x << 32 | (uint32_t)(int) world->pos_y;
+            if (coords_value != coords) {
+                std::stringstream ss;
+                ss << std::right << "("
+                    << std::setw(4) << std::to_string((int) world->pos_x)
+                    << std::setw(0) << ", "
+                    << std::setw(4) << std::to_string((int)world->pos_y)
+                    << std::setw(0) << ")"
+                    << std::endl;
+
+                UpdateTextLabel(&coords_label, ss.str());
+                coords_value = coords;
+            }
 
-            DrawString(4, ScreenHeight() - 3 * 8, ss.str());
+            draw_overlay_label(4, ScreenHeight() - 3 * 8, &coords_label);
         }
 #endif
 
-        if (is_won) {
-            return GS_WON;
-        } else {
-            return GS_MAIN;
-        }
+        return tick_state;
     }
 
 	uint8_t won()
@@ -724,7 +895,7 @@ public:
         }
         Clear(olc::BLACK);
 
-        SetPixelMode(olc::Pixel::MASK);
+        SetPixelMode(olc::Pixel::PREMUL);
         DrawSprite(ScreenWidth() / 2 - 8, ScreenHeight() / 2 - 8, world->player.get());
 
         for (int i = 0; i < 6; i++) {
@@ -749,6 +920,7 @@ public:
                     return GS_TITLE;
             }
         }
+        int last_option = option;
         if (GetKey(olc::UP).bPressed || GetKey(olc::W).bPressed || GetKey(olc::K).bPressed) {
             option--;
         }
@@ -759,16 +931,23 @@ public:
         if (timer > 300) {
             return GS_TITLE;
         }
-        Clear(olc::BLACK);
-        DrawString(ScreenWidth() / 2 - 3 * 8, ScreenHeight() / 4 - 4, "Paused");
-        DrawString(ScreenWidth() / 2 - 3 * 8, ScreenHeight() / 2 - 4, "Resume");
-        DrawString(ScreenWidth() / 2 - 2 * 8, ScreenHeight() / 2 + 4, "Exit");
-        DrawString(ScreenWidth() / 2 - 5 * 8, ScreenHeight() / 2 - 4 + option * 8, "*");
+        if (redraw || !partial_redraw) {
+            Clear(olc::BLACK);
+            DrawString(ScreenWidth() / 2 - 3 * 8, ScreenHeight() / 4 - 4, "Paused");
+            DrawString(ScreenWidth() / 2 - 3 * 8, ScreenHeight() / 2 - 4, "Resume");
+            DrawString(ScreenWidth() / 2 - 2 * 8, ScreenHeight() / 2 + 4, "Exit");
+            DrawString(ScreenWidth() / 2 - 5 * 8, ScreenHeight() / 2 - 4 + option * 8, "*");
+            redraw = false;
+        } else if (option != last_option) {
+            FillRect(ScreenWidth() / 2 - 5 * 8, ScreenHeight() / 2 - 4, 8, 2 * 8, olc::BLACK);
+            DrawString(ScreenWidth() / 2 - 5 * 8, ScreenHeight() / 2 - 4 + option * 8, "*");
+        }
         return GS_PAUSE;
     }
 
     uint8_t license()
     {
+        int last_option = option;
         if (GetKey(olc::S).bPressed || GetKey(olc::J).bPressed || GetKey(olc::DOWN).bPressed) {
             option++;
         }
@@ -789,6 +968,11 @@ public:
 
         option = clamp<int>(option, 0, license_text.size() - 1);
 
+        if (partial_redraw && !redraw && option == last_option) {
+            return GS_LICENSE;
+        }
+        redraw = false;
+
         Clear(olc::BLACK);
 
         int pos_y = 0;
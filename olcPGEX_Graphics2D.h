@@ -73,6 +73,9 @@
 #define OLC_PGEX_GFX2D
 
 #include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
 #undef min
 #undef max
 
@@ -107,6 +110,30 @@ namespace olc
 			 void Backward(float in_x, float in_y, float &out_x, float &out_y);
 			// Regenerate the Inverse Transformation
 			 void Invert();
+			// Transform n points at once, out may be the same arrays as in
+			 void Forward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n);
+			 void Backward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n);
+
+		public:
+			// A copy of the composed transform and its inverse, which can be kept
+			// and applied to any number of points without rebuilding the stack
+			struct Frozen
+			{
+				float forward[3][3];
+				float inverse[3][3];
+				bool bAffineForward;
+				bool bAffineInverse;
+
+				void Forward(float in_x, float in_y, float &out_x, float &out_y) const;
+				void Backward(float in_x, float in_y, float &out_x, float &out_y) const;
+				void Forward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n) const;
+				void Backward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n) const;
+				// Bounding box (sx,sy) to (ex,ey) of the rectangle (0,0) to (w,h) once transformed
+				void Bounds(float w, float h, float &sx, float &sy, float &ex, float &ey) const;
+			};
+
+			// Inverts if needed, then copies out the current transform
+			 Frozen Freeze();
 
 		private:
 			 void Multiply();
@@ -114,11 +141,71 @@ namespace olc
 			int nTargetMatrix;
 			int nSourceMatrix;
 			bool bDirty;
+
+			friend class GFX2D;
+		};
+
+	public:
+		// Keeps rotated and scaled copies of sprites, so drawing a sprite at an
+		// angle and scale it was drawn at before is a plain blit. Angles and
+		// scales are rounded to steps, and the least recently used copies are
+		// dropped once the memory budget is used up. Call Clear() if a cached
+		// sprite is changed or deleted.
+		class TransformCache
+		{
+		public:
+			TransformCache(size_t nBudgetBytes = 8 * 1024 * 1024, int32_t nAngleSteps = 64, float fScaleStep = 1.0f / 16.0f);
+
+		public:
+			// Draws a sprite rotated by fAngle radians and scaled by fScale about
+			// its centre, with the centre placed at (x,y)
+			void DrawSprite(olc::Sprite *sprite, float x, float y, float fAngle, float fScale = 1.0f);
+			// Number of steps in a full turn, and the size of a scale step
+			void SetQuantization(int32_t nAngleSteps, float fScaleStep);
+			void SetBudget(size_t nBudgetBytes);
+			// Drops every cached copy
+			void Clear();
+
+		public:
+			size_t GetHits();
+			size_t GetMisses();
+			size_t GetMemoryUsage();
+			void ResetCounters();
+
+		private:
+			struct sKey
+			{
+				olc::Sprite *sprite;
+				int32_t nAngle;
+				int32_t nScale;
+				bool operator<(const sKey &k) const;
+			};
+
+			struct sEntry
+			{
+				std::unique_ptr<olc::Sprite> pSprite;
+				// Where the centre of the original ends up in the copy
+				float cx, cy;
+				std::list<sKey>::iterator itLRU;
+			};
+
+			void Trim();
+
+			std::map<sKey, sEntry> mapEntries;
+			// Most recently used at the front
+			std::list<sKey> listLRU;
+			size_t nBudget;
+			size_t nBytes = 0;
+			int32_t nAngleSteps;
+			float fScaleStep;
+			size_t nHits = 0;
+			size_t nMisses = 0;
 		};
 
 	public:
-		// Draws a sprite with the transform applied
-		 static void DrawSprite(olc::Sprite *sprite, olc::GFX2D::Transform2D &transform);
+		// Draws a sprite with the transform applied, filtered bilinearly if asked
+		 static void DrawSprite(olc::Sprite *sprite, olc::GFX2D::Transform2D &transform, bool bFiltered = false);
+		 static void DrawSprite(olc::Sprite *sprite, const olc::GFX2D::Transform2D::Frozen &transform, bool bFiltered = false);
 	};
 }
 
@@ -128,58 +215,392 @@ namespace olc
 
 namespace olc
 {
-	void GFX2D::DrawSprite(olc::Sprite *sprite, olc::GFX2D::Transform2D &transform)
+	// Transforms n points through m, when the matrix is affine z is the same
+	// for every point so the divide is skipped, or done by a constant
+	static void olc_TransformPoints(const float m[3][3], bool bAffine, const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n)
+	{
+		const bool bDivide = !bAffine || (m[2][2] != 0.0f && m[2][2] != 1.0f);
+		size_t i = 0;
+#ifdef OLC_SIMD_SSE2
+		const __m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]);
+		const __m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]);
+		const __m128 m02 = _mm_set1_ps(m[0][2]), m12 = _mm_set1_ps(m[1][2]), m22 = _mm_set1_ps(m[2][2]);
+		for (; i + 4 <= n; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(in_x + i), y = _mm_loadu_ps(in_y + i);
+			__m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), m20);
+			__m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), m21);
+			if (bDivide)
+			{
+				// Same as the scalar version, points with z of 0 are left undivided
+				const __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), m22);
+				const __m128 nz = _mm_cmpneq_ps(z, _mm_setzero_ps());
+				ox = _mm_or_ps(_mm_and_ps(nz, _mm_div_ps(ox, z)), _mm_andnot_ps(nz, ox));
+				oy = _mm_or_ps(_mm_and_ps(nz, _mm_div_ps(oy, z)), _mm_andnot_ps(nz, oy));
+			}
+			_mm_storeu_ps(out_x + i, ox);
+			_mm_storeu_ps(out_y + i, oy);
+		}
+#endif
+		for (; i < n; i++)
+		{
+			const float x = in_x[i], y = in_y[i];
+			float ox = x * m[0][0] + y * m[1][0] + m[2][0];
+			float oy = x * m[0][1] + y * m[1][1] + m[2][1];
+			if (bDivide)
+			{
+				const float z = x * m[0][2] + y * m[1][2] + m[2][2];
+				if (z != 0) { ox /= z; oy /= z; }
+			}
+			out_x[i] = ox;
+			out_y[i] = oy;
+		}
+	}
+
+	void GFX2D::DrawSprite(olc::Sprite *sprite, olc::GFX2D::Transform2D &transform, bool bFiltered)
 	{
-		if (sprite == nullptr)
+		DrawSprite(sprite, transform.Freeze(), bFiltered);
+	}
+
+	void GFX2D::DrawSprite(olc::Sprite *sprite, const olc::GFX2D::Transform2D::Frozen &transform, bool bFiltered)
+	{
+		if (sprite == nullptr || pge->GetDrawTarget() == nullptr)
 			return;
 
 		// Work out bounding rectangle of sprite
-		float ex, ey;
-		float sx, sy;
-		float px, py;
+		float sx, sy, ex, ey;
+		transform.Bounds((float)sprite->width, (float)sprite->height, sx, sy, ex, ey);
+
+		// Clip the pixels inside the rectangle to the draw target
+		const int32_t x1 = std::max(0, (int32_t)std::ceil(std::max(sx, -1.0f)));
+		const int32_t y1 = std::max(0, (int32_t)std::ceil(std::max(sy, -1.0f)));
+		const int32_t x2 = (int32_t)std::ceil(std::min(ex, (float)pge->GetDrawTargetWidth()));
+		const int32_t y2 = (int32_t)std::ceil(std::min(ey, (float)pge->GetDrawTargetHeight()));
+		if (x1 >= x2 || y1 >= y2)
+			return;
 
-		transform.Forward(0.0f, 0.0f, sx, sy);
-		px = sx; py = sy;
-		sx = std::min(sx, px); sy = std::min(sy, py);
-		ex = std::max(ex, px); ey = std::max(ey, py);
+		// Source coordinates are linear along a row before the divide by z, so
+		// affine transforms just step them, and perspective ones divide at the
+		// ends of short spans and step in between
+		const float (&m)[3][3] = transform.inverse;
+		const bool bAffine = transform.bAffineInverse;
+		const int32_t nSpan = bAffine ? x2 - x1 : 16;
+		const bool bPeriodic = sprite->GetSampleMode() == olc::Sprite::Mode::PERIODIC;
 
-		transform.Forward((float)sprite->width, (float)sprite->height, px, py);
-		sx = std::min(sx, px); sy = std::min(sy, py);
-		ex = std::max(ex, px); ey = std::max(ey, py);
+		auto Project = [&](float x, float y, float &u, float &v)
+		{
+			u = x * m[0][0] + y * m[1][0] + m[2][0];
+			v = x * m[0][1] + y * m[1][1] + m[2][1];
+			float z = x * m[0][2] + y * m[1][2] + m[2][2];
+			if (z != 0) { u /= z; v /= z; }
+		};
 
-		transform.Forward(0.0f, (float)sprite->height, px, py);
-		sx = std::min(sx, px); sy = std::min(sy, py);
-		ex = std::max(ex, px); ey = std::max(ey, py);
+		const float fw = (float)sprite->width, fh = (float)sprite->height;
+		const olc::Pixel *pSrc = sprite->GetData();
+		const int32_t nStride = sprite->GetStride();
 
-		transform.Forward((float)sprite->width, 0.0f, px, py);
-		sx = std::min(sx, px); sy = std::min(sy, py);
-		ex = std::max(ex, px); ey = std::max(ey, py);
+		// Narrows lo to hi down to where a + b * (x - x1) lies in 0 to l
+		auto Limit = [&](float a, float b, float l, float &lo, float &hi)
+		{
+			if (b == 0.0f) { if (a < 0.0f || a >= l) hi = lo; return; }
+			float t0 = -a / b, t1 = (l - a) / b;
+			lo = std::max(lo, x1 + std::min(t0, t1));
+			hi = std::min(hi, x1 + std::max(t0, t1));
+		};
 
-		// Perform inversion of transform if required
-		transform.Invert();
+		std::vector<olc::Pixel> vRow(x2 - x1);
+		for (int32_t y = y1; y < y2; y++)
+		{
+			if (bAffine && bFiltered)
+			{
+				// Filtered samples are taken at pixel centres, the row is stepped
+				// through the sprite in fixed point
+				float u, v, u2, v2;
+				Project((float)x1 + 0.5f, (float)y + 0.5f, u, v);
+				Project((float)x1 + 1.5f, (float)y + 0.5f, u2, v2);
+				const float du = u2 - u, dv = v2 - v;
+
+				float lo = (float)x1, hi = (float)x2;
+				if (!bPeriodic)
+				{
+					Limit(u, du, fw, lo, hi);
+					Limit(v, dv, fh, lo, hi);
+				}
+
+				const int32_t xa = std::max(x1, (int32_t)std::ceil(lo)), xb = std::min(x2, (int32_t)std::ceil(hi));
+				if (xa >= xb) continue;
+				sprite->SampleRowBL(u + du * (xa - x1), v + dv * (xa - x1), du, dv, vRow.data(), xb - xa);
+				DrawRow(xa, y, vRow.data(), xb - xa);
+				continue;
+			}
 
-		if (ex < sx)
-			std::swap(ex, sx);
-		if (ey < sy)
-			std::swap(ey, sy);
+			if (bAffine && !bPeriodic)
+			{
+				// The texel coordinates are linear in x, so solve for the part of
+				// the row where both land inside the sprite, then just step them
+				float u, v, u2, v2;
+				Project((float)x1, (float)y, u, v);
+				Project((float)x1 + 1.0f, (float)y, u2, v2);
+				u += 0.5f; v += 0.5f;
+				const float du = u2 + 0.5f - u, dv = v2 + 0.5f - v;
+
+				float lo = (float)x1, hi = (float)x2;
+				Limit(u, du, fw, lo, hi);
+				Limit(v, dv, fh, lo, hi);
+
+				const int32_t xa = std::max(x1, (int32_t)std::ceil(lo)), xb = std::min(x2, (int32_t)std::ceil(hi));
+				if (xa >= xb) continue;
+
+				// Rounding at the edges can put the ends a fraction outside, so clamp
+				u += du * (xa - x1); v += dv * (xa - x1);
+				const int32_t mu = sprite->width - 1, mv = sprite->height - 1;
+				for (int32_t x = xa; x < xb; x++, u += du, v += dv)
+				{
+					const int32_t iu = std::min(std::max((int32_t)u, 0), mu), iv = std::min(std::max((int32_t)v, 0), mv);
+					vRow[x - xa] = pSrc[iv * nStride + iu];
+				}
+				DrawRow(xa, y, vRow.data(), xb - xa);
+				continue;
+			}
 
-		// Iterate through render space, and sample Sprite from suitable texel location
-		for (float i = sx; i < ex; i++)
-		{
-			for (float j = sy; j < ey; j++)
+			// Texels outside the sprite are skipped, so the row is drawn as runs
+			int32_t nRunStart = x1, nRun = 0;
+			for (int32_t x = x1; x < x2;)
 			{
-				float ox, oy;
-				transform.Backward(i, j, ox, oy);
-				pge->Draw((int32_t)i, (int32_t)j, sprite->GetPixel((int32_t)(ox+0.5f), (int32_t)(oy+0.5f)));
+				const int32_t n = std::min(nSpan, x2 - x);
+				// Sample at the nearest texel, or filter around the pixel centre
+				const float c = bFiltered ? 0.5f : 0.0f;
+				float u, v, u2, v2;
+				Project((float)x + c, (float)y + c, u, v);
+				Project((float)(x + n) + c, (float)y + c, u2, v2);
+				const float du = (u2 - u) / n, dv = (v2 - v) / n;
+				if (!bFiltered) { u += 0.5f; v += 0.5f; }
+
+				// Filtered pixels inside the span are sampled a run at a time
+				int32_t nSample = 0;
+				float us = 0.0f, vs = 0.0f;
+				for (int32_t i = 0; i < n; i++, x++, u += du, v += dv)
+				{
+					const bool bInside = bPeriodic || (u >= 0.0f && v >= 0.0f && u < fw && v < fh);
+					if (bInside)
+					{
+						if (nRun == 0) nRunStart = x;
+						if (bFiltered)
+						{
+							if (nSample++ == 0) { us = u; vs = v; }
+						}
+						else
+							vRow[x - x1] = bPeriodic ? sprite->GetPixel((int32_t)std::floor(u), (int32_t)std::floor(v)) : pSrc[(int32_t)v * nStride + (int32_t)u];
+						nRun++;
+					}
+					else
+					{
+						if (nSample > 0)
+						{
+							sprite->SampleRowBL(us, vs, du, dv, &vRow[x - nSample - x1], nSample);
+							nSample = 0;
+						}
+						if (nRun > 0)
+						{
+							DrawRow(nRunStart, y, &vRow[nRunStart - x1], nRun);
+							nRun = 0;
+						}
+					}
+				}
+				if (nSample > 0)
+					sprite->SampleRowBL(us, vs, du, dv, &vRow[x - nSample - x1], nSample);
 			}
+			if (nRun > 0)
+				DrawRow(nRunStart, y, &vRow[nRunStart - x1], nRun);
 		}
 	}
 
+	olc::GFX2D::TransformCache::TransformCache(size_t nBudgetBytes, int32_t nAngleSteps, float fScaleStep)
+	{
+		nBudget = nBudgetBytes;
+		SetQuantization(nAngleSteps, fScaleStep);
+	}
+
+	bool olc::GFX2D::TransformCache::sKey::operator<(const sKey &k) const
+	{
+		if (sprite != k.sprite) return std::less<olc::Sprite*>()(sprite, k.sprite);
+		if (nAngle != k.nAngle) return nAngle < k.nAngle;
+		return nScale < k.nScale;
+	}
+
+	void olc::GFX2D::TransformCache::DrawSprite(olc::Sprite *sprite, float x, float y, float fAngle, float fScale)
+	{
+		if (sprite == nullptr || fScale <= 0.0f)
+			return;
+
+		// Round the angle to a step of a full turn, and the scale to a multiple of the step
+		const float fTurn = 6.28318530718f;
+		int32_t nAngle = (int32_t)std::floor(fAngle / fTurn * nAngleSteps + 0.5f) % nAngleSteps;
+		if (nAngle < 0) nAngle += nAngleSteps;
+		const int32_t nScale = std::max(1, (int32_t)std::floor(fScale / fScaleStep + 0.5f));
+		const sKey key = { sprite, nAngle, nScale };
+
+		auto it = mapEntries.find(key);
+		if (it != mapEntries.end())
+		{
+			nHits++;
+			listLRU.splice(listLRU.begin(), listLRU, it->second.itLRU);
+		}
+		else
+		{
+			nMisses++;
+
+			// Render the copy once, into a sprite just big enough to hold it
+			olc::GFX2D::Transform2D transform;
+			transform.Translate(-sprite->width / 2.0f, -sprite->height / 2.0f);
+			transform.Rotate(nAngle * fTurn / nAngleSteps);
+			transform.Scale(nScale * fScaleStep, nScale * fScaleStep);
+
+			float sx, sy, ex, ey;
+			transform.Freeze().Bounds((float)sprite->width, (float)sprite->height, sx, sy, ex, ey);
+			transform.Translate(-std::floor(sx), -std::floor(sy));
+
+			sEntry entry;
+			entry.pSprite.reset(new olc::Sprite((int32_t)std::ceil(ex) - (int32_t)std::floor(sx) + 1, (int32_t)std::ceil(ey) - (int32_t)std::floor(sy) + 1));
+			entry.cx = -std::floor(sx);
+			entry.cy = -std::floor(sy);
+
+			olc::Sprite *pTarget = pge->GetDrawTarget();
+			olc::Pixel::Mode m = pge->GetPixelMode();
+			pge->SetDrawTarget(entry.pSprite.get());
+			pge->SetPixelMode(olc::Pixel::NORMAL);
+			pge->Clear(olc::BLANK);
+			GFX2D::DrawSprite(sprite, transform);
+			pge->SetPixelMode(m);
+			pge->SetDrawTarget(pTarget);
+
+			listLRU.push_front(key);
+			entry.itLRU = listLRU.begin();
+			nBytes += entry.pSprite->GetStride() * entry.pSprite->height * sizeof(olc::Pixel);
+			it = mapEntries.emplace(key, std::move(entry)).first;
+			Trim();
+		}
+
+		olc::Sprite *pCopy = it->second.pSprite.get();
+		pge->DrawSprite((int32_t)std::floor(x - it->second.cx + 0.5f), (int32_t)std::floor(y - it->second.cy + 0.5f), pCopy);
+	}
+
+	void olc::GFX2D::TransformCache::Trim()
+	{
+		// The most recent copy stays, even if it is bigger than the whole budget.
+		// Queued draws may still read the copies that go
+		if (nBytes > nBudget && listLRU.size() > 1 && pge != nullptr)
+			pge->FlushDrawing();
+		while (nBytes > nBudget && listLRU.size() > 1)
+		{
+			auto it = mapEntries.find(listLRU.back());
+			nBytes -= it->second.pSprite->GetStride() * it->second.pSprite->height * sizeof(olc::Pixel);
+			mapEntries.erase(it);
+			listLRU.pop_back();
+		}
+	}
+
+	void olc::GFX2D::TransformCache::SetQuantization(int32_t nAngleSteps, float fScaleStep)
+	{
+		this->nAngleSteps = std::max(1, nAngleSteps);
+		this->fScaleStep = fScaleStep > 0.0f ? fScaleStep : 1.0f / 16.0f;
+		Clear();
+	}
+
+	void olc::GFX2D::TransformCache::SetBudget(size_t nBudgetBytes)
+	{
+		nBudget = nBudgetBytes;
+		Trim();
+	}
+
+	void olc::GFX2D::TransformCache::Clear()
+	{
+		if (!mapEntries.empty() && pge != nullptr)
+			pge->FlushDrawing();
+		mapEntries.clear();
+		listLRU.clear();
+		nBytes = 0;
+	}
+
+	size_t olc::GFX2D::TransformCache::GetHits()
+	{
+		return nHits;
+	}
+
+	size_t olc::GFX2D::TransformCache::GetMisses()
+	{
+		return nMisses;
+	}
+
+	size_t olc::GFX2D::TransformCache::GetMemoryUsage()
+	{
+		return nBytes;
+	}
+
+	void olc::GFX2D::TransformCache::ResetCounters()
+	{
+		nHits = 0;
+		nMisses = 0;
+	}
+
 	olc::GFX2D::Transform2D::Transform2D()
 	{
 		Reset();
 	}
 
+	void olc::GFX2D::Transform2D::Forward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n)
+	{
+		const float (&m)[3][3] = matrix[nSourceMatrix];
+		olc_TransformPoints(m, m[0][2] == 0.0f && m[1][2] == 0.0f, in_x, in_y, out_x, out_y, n);
+	}
+
+	void olc::GFX2D::Transform2D::Backward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n)
+	{
+		const float (&m)[3][3] = matrix[3];
+		olc_TransformPoints(m, m[0][2] == 0.0f && m[1][2] == 0.0f, in_x, in_y, out_x, out_y, n);
+	}
+
+	olc::GFX2D::Transform2D::Frozen olc::GFX2D::Transform2D::Freeze()
+	{
+		Invert();
+		Frozen f;
+		memcpy(f.forward, matrix[nSourceMatrix], sizeof(f.forward));
+		memcpy(f.inverse, matrix[3], sizeof(f.inverse));
+		f.bAffineForward = f.forward[0][2] == 0.0f && f.forward[1][2] == 0.0f;
+		f.bAffineInverse = f.inverse[0][2] == 0.0f && f.inverse[1][2] == 0.0f;
+		return f;
+	}
+
+	void olc::GFX2D::Transform2D::Frozen::Forward(float in_x, float in_y, float &out_x, float &out_y) const
+	{
+		olc_TransformPoints(forward, bAffineForward, &in_x, &in_y, &out_x, &out_y, 1);
+	}
+
+	void olc::GFX2D::Transform2D::Frozen::Backward(float in_x, float in_y, float &out_x, float &out_y) const
+	{
+		olc_TransformPoints(inverse, bAffineInverse, &in_x, &in_y, &out_x, &out_y, 1);
+	}
+
+	void olc::GFX2D::Transform2D::Frozen::Forward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n) const
+	{
+		olc_TransformPoints(forward, bAffineForward, in_x, in_y, out_x, out_y, n);
+	}
+
+	void olc::GFX2D::Transform2D::Frozen::Backward(const float *in_x, const float *in_y, float *out_x, float *out_y, size_t n) const
+	{
+		olc_TransformPoints(inverse, bAffineInverse, in_x, in_y, out_x, out_y, n);
+	}
+
+	void olc::GFX2D::Transform2D::Frozen::Bounds(float w, float h, float &sx, float &sy, float &ex, float &ey) const
+	{
+		float x[4] = { 0.0f, w, 0.0f, w }, y[4] = { 0.0f, h, h, 0.0f };
+		Forward(x, y, x, y, 4);
+		sx = std::min(std::min(x[0], x[1]), std::min(x[2], x[3]));
+		sy = std::min(std::min(y[0], y[1]), std::min(y[2], y[3]));
+		ex = std::max(std::max(x[0], x[1]), std::max(x[2], x[3]));
+		ey = std::max(std::max(y[0], y[1]), std::max(y[2], y[3]));
+	}
+
 	void olc::GFX2D::Transform2D::Reset()
 	{
 		nTargetMatrix = 0;
@@ -214,6 +214,8 @@
 // Standard includes
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <streambuf>
@@ -223,11 +225,25 @@
 #include <thread>
 #include <atomic>
 #include <condition_variable>
+#include <mutex>
 #include <fstream>
 #include <map>
 #include <functional>
 #include <algorithm>
 
+// SIMD kernels are used for span operations where the compiler allows them,
+// define OLC_NO_SIMD to force the plain C++ versions
+#ifndef OLC_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define OLC_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+	#define OLC_SIMD_AVX2
+	#include <immintrin.h>
+#endif
+#endif
+
 #undef min
 #undef max
 
@@ -247,7 +263,7 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		Pixel();
 		Pixel(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = 255);
 		Pixel(uint32_t p);
-		enum Mode { NORMAL, MASK, ALPHA, CUSTOM };
+		enum Mode { NORMAL, MASK, ALPHA, CUSTOM, PREMUL };
 
 		bool operator==(const Pixel& p) const;
 		bool operator!=(const Pixel& p) const;
@@ -351,7 +367,9 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 
 	//=============================================================
 
-	// A bitmap-like structure that stores a 2D array of Pixels
+	// A bitmap-like structure that stores a 2D array of Pixels. The array starts
+	// on a cache line and each row is padded to start on a 32 byte boundary, so
+	// rows are GetStride() pixels apart rather than width
 	class Sprite
 	{
 	public:
@@ -359,6 +377,10 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		Sprite(std::string sImageFile);
 		Sprite(std::string sImageFile, olc::ResourcePack *pack);
 		Sprite(int32_t w, int32_t h);
+		Sprite(Sprite &&sprite);
+		Sprite& operator=(Sprite &&sprite);
+		Sprite(const Sprite&) = delete;
+		Sprite& operator=(const Sprite&) = delete;
 		~Sprite();
 
 	public:
@@ -373,26 +395,193 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 
 	public:
 		void SetSampleMode(olc::Sprite::Mode mode = olc::Sprite::Mode::NORMAL);
+		olc::Sprite::Mode GetSampleMode();
 		Pixel GetPixel(int32_t x, int32_t y);
 		bool  SetPixel(int32_t x, int32_t y, Pixel p);
 
 		Pixel Sample(float x, float y);
 		Pixel SampleBL(float u, float v);
+		// Fills n pixels with bilinear samples along a line starting at texel
+		// position (x,y) and stepping by (dx,dy), texel i covering i to i+1.
+		// Edges clamp or wrap as set by the sample mode
+		void SampleRowBL(float x, float y, float dx, float dy, Pixel *pDst, int32_t n);
 		Pixel* GetData();
+		// Pixels from the start of one row to the start of the next
+		int32_t GetStride() const;
+		Pixel* GetRow(int32_t y);
+
+		// Converts the sprite to premultiplied alpha, for use with olc::Pixel::PREMUL
+		void Premultiply();
+		bool IsPremultiplied();
+
+	private:
+		// Replaces the pixel array with an uninitialised one of w by h
+		void Allocate(int32_t w, int32_t h);
+		void Free();
 
 	private:
 		Pixel *pColData = nullptr;
+		int32_t nStride = 0;
 		Mode modeSample = Mode::NORMAL;
+		bool bPremultiplied = false;
 
 #ifdef OLC_DBG_OVERDRAW
 	public:
-		static int nOverdrawCount;
+		static std::atomic<int> nOverdrawCount;
 #endif
 
 	};
 
 	//=============================================================
 
+	// A rectangle of another sprite that is read and drawn in place, without a
+	// copy. It does not own the pixels, so it must not outlive the sprite
+	class SpriteView
+	{
+	public:
+		SpriteView();
+		explicit SpriteView(Sprite *sprite);
+		// The area (ox,oy) to (ox+w,oy+h), clipped to the sprite
+		SpriteView(Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h);
+
+	public:
+		int32_t width = 0;
+		int32_t height = 0;
+
+	public:
+		Pixel GetPixel(int32_t x, int32_t y) const;
+		Pixel* GetData() const;
+		Pixel* GetRow(int32_t y) const;
+		int32_t GetStride() const;
+		Sprite* GetSprite() const;
+		// The area (ox,oy) to (ox+w,oy+h) of this view, clipped to it
+		SpriteView SubView(int32_t ox, int32_t oy, int32_t w, int32_t h) const;
+
+	private:
+		Sprite *pSprite = nullptr;
+		Pixel *pData = nullptr;
+		int32_t nStride = 0;
+	};
+
+	//=============================================================
+
+	class TiledSprite;
+
+	// A read-only copy of a Sprite, stored per row as runs of (skip N transparent,
+	// copy M opaque, blend K translucent) pixels, so that drawing it only touches
+	// the visible pixels. Skipped pixels are left alone in every pixel mode.
+	class CompiledSprite
+	{
+	public:
+		CompiledSprite();
+		CompiledSprite(Sprite *sprite);
+		CompiledSprite(TiledSprite *sprite);
+
+	public:
+		olc::rcode Compile(Sprite *sprite);
+		olc::rcode Compile(TiledSprite *sprite);
+
+	public:
+		int32_t width = 0;
+		int32_t height = 0;
+
+		struct sRun
+		{
+			uint16_t nSkip;
+			uint16_t nCopy;
+			uint16_t nBlend;
+		};
+
+	private:
+		// Runs and their pixels, each row starts at vRowRuns[y] and vRowPixels[y]
+		std::vector<sRun> vRuns;
+		std::vector<Pixel> vPixels;
+		std::vector<uint32_t> vRowRuns;
+		std::vector<uint32_t> vRowPixels;
+
+		void CompileRow(const Pixel *pRow);
+
+		friend class PixelGameEngine;
+	};
+
+	//=============================================================
+
+	// A read-only copy of a Sprite split into square tiles. Tiles of a single
+	// colour are stored as just that colour, fully transparent tiles are flagged
+	// as empty, and identical tiles share one copy in the tileset. Fully
+	// transparent pixels are stored as olc::BLANK.
+	class TiledSprite
+	{
+	public:
+		TiledSprite();
+		TiledSprite(std::string sImageFile, olc::ResourcePack *pack = nullptr);
+		TiledSprite(Sprite *sprite, int32_t nTileSize = 32);
+
+	public:
+		olc::rcode LoadFromFile(std::string sImageFile, olc::ResourcePack *pack = nullptr);
+		olc::rcode Build(Sprite *sprite, int32_t nTileSize = 32);
+
+	public:
+		int32_t width = 0;
+		int32_t height = 0;
+
+	public:
+		Pixel GetPixel(int32_t x, int32_t y);
+		// Copies row y into pRow, which must hold width pixels
+		void GetRow(int32_t y, Pixel *pRow);
+		// Bytes used by the tile table and tileset
+		size_t GetMemoryUsage();
+
+	private:
+		enum TileKind : uint8_t { EMPTY, UNIFORM, STORED };
+
+		struct sTile
+		{
+			TileKind nKind;
+			Pixel colour;
+			uint32_t nIndex;
+		};
+
+		int32_t nTileSize = 32;
+		int32_t nTilesX = 0;
+		int32_t nTilesY = 0;
+		std::vector<sTile> vTiles;
+		// nTileSize * nTileSize pixels per stored tile, edge tiles padded with olc::BLANK
+		std::vector<Pixel> vTileset;
+
+		friend class PixelGameEngine;
+	};
+
+	//=============================================================
+
+	// A string rendered once into a sprite, so drawing it again is a single
+	// masked blit. It is only re-rendered when its text, colour or scale change.
+	class TextLabel
+	{
+	public:
+		TextLabel();
+		~TextLabel();
+		TextLabel(const TextLabel&) = delete;
+		TextLabel &operator=(const TextLabel&) = delete;
+
+	public:
+		int32_t width = 0;
+		int32_t height = 0;
+
+	public:
+		const std::string &GetText();
+
+	private:
+		std::string sText;
+		Pixel colour;
+		uint32_t nScale = 0;
+		Sprite *pSprite = nullptr;
+
+		friend class PixelGameEngine;
+	};
+
+	//=============================================================
+
 	enum Key
 	{
 		NONE,
@@ -423,6 +612,13 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		virtual bool OnUserCreate();
 		// Called every frame, and provides you with a time per frame value
 		virtual bool OnUserUpdate(float fElapsedTime);
+		// Called at the fixed rate set by SetFixedUpdateRate(), with the same
+		// time per tick every time, before the frame is drawn
+		virtual bool OnUserFixedUpdate(float fTickTime);
+		// Called every frame after the fixed updates, fAlpha is how far the frame
+		// lies between the last tick and the next, from 0 to 1, for drawing moving
+		// things part way. By default it calls OnUserUpdate
+		virtual bool OnUserRender(float fElapsedTime, float fAlpha);
 		// Called once on application termination, so you can be a clean coder
 		virtual bool OnUserDestroy();
 
@@ -460,10 +656,14 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		// olc::Pixel::NORMAL = No transparency
 		// olc::Pixel::MASK   = Transparent if alpha is < 255
 		// olc::Pixel::ALPHA  = Full transparency
+		// olc::Pixel::PREMUL = Full transparency, for premultiplied sprites
 		void SetPixelMode(Pixel::Mode m);
 		Pixel::Mode GetPixelMode();
 		// Use a custom blend function
 		void SetPixelMode(std::function<olc::Pixel(const int x, const int y, const olc::Pixel& pSource, const olc::Pixel& pDest)> pixelMode);
+		// Use a custom blend functor or lambda, it is compiled into the row loops
+		// used by sprites, text and fills, so is called directly for each pixel
+		template<typename F> void SetPixelMode(F pixelMode);
 		// Change the blend factor form between 0.0f to 1.0f;
 		void SetPixelBlend(float fBlend);
 		// Offset texels by sub-pixel amount (advanced, do not use)
@@ -490,13 +690,101 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		// Draws an area of a sprite at location (x,y), where the
 		// selected area is (ox,oy) to (ox+w,oy+h)
 		void DrawPartialSprite(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale = 1);
+		// Draws a view of a sprite at location (x,y)
+		void DrawSprite(int32_t x, int32_t y, const SpriteView &view);
+		// Draws a sprite at a fractional location, scaled by any amount with
+		// bilinear filtering
+		void DrawSpriteFiltered(float x, float y, Sprite *sprite, float scale);
+		// Draws an area of a sprite scaled with bilinear filtering, the filter
+		// does not read outside (ox,oy) to (ox+w,oy+h)
+		void DrawPartialSpriteFiltered(float x, float y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, float scale);
+		// Draws an entire compiled sprite at location (x,y)
+		void DrawSprite(int32_t x, int32_t y, CompiledSprite *sprite);
+		// Draws an area of a compiled sprite at location (x,y), where the
+		// selected area is (ox,oy) to (ox+w,oy+h)
+		void DrawPartialSprite(int32_t x, int32_t y, CompiledSprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h);
+		// Draws a tiled sprite, empty tiles are skipped except in NORMAL mode
+		void DrawSprite(int32_t x, int32_t y, TiledSprite *sprite);
+		void DrawPartialSprite(int32_t x, int32_t y, TiledSprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h);
 		// Draws a single line of text
 		void DrawString(int32_t x, int32_t y, std::string sText, Pixel col = olc::WHITE, uint32_t scale = 1);
+		// Renders text into a label, does nothing if it already shows the same text,
+		// colour and scale. Returns true if the label was re-rendered
+		bool UpdateTextLabel(TextLabel *label, const std::string &sText, Pixel col = olc::WHITE, uint32_t scale = 1);
+		// Draws a label as DrawString would have drawn its text
+		void DrawTextLabel(int32_t x, int32_t y, TextLabel *label);
 		// Clears entire draw target to Pixel
 		void Clear(Pixel p);
 		// Resize the primary screen sprite
 		void SetScreenSize(int w, int h);
 
+	public: // Scrolling Backgrounds
+		// Fills the draw target with the area of an opaque background sprite that
+		// starts at (vx,vy). If the same background was drawn last frame, what is
+		// still visible is shifted into place and only newly exposed strips are
+		// copied from the background.
+		void DrawScrollingBackground(Sprite *background, int32_t vx, int32_t vy);
+		// Anything drawn over the scrolling background must be registered here
+		// each frame, so it can be restored before the next scroll
+		void AddScrollingOverlay(int32_t x, int32_t y, int32_t w, int32_t h);
+		// Forces the next scrolling background to be drawn in full, call it
+		// whenever the draw target was changed in any other way
+		void InvalidateScrollingBackground();
+
+	public: // Dirty Rectangles
+		// When enabled, everything drawn to the screen is recorded as a set of
+		// dirty rectangles, and only the rows they cover are uploaded each frame.
+		// The screen then keeps its contents, so only changed areas need redrawing.
+		void EnableDirtyRects(bool bEnable);
+		// Reports an area of the screen that was changed without a draw call
+		void MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h);
+		// Outlines the dirty rectangles of each frame on screen (debugging aid)
+		void SetDirtyRectOverlay(bool bShow);
+
+	public: // Fixed Timestep
+		// Runs OnUserFixedUpdate fRate times a second of game time, 0 to stop.
+		// At most nMaxTicks run in one frame, time beyond that is dropped so a
+		// slow frame doesn't lead to ever more ticks. During a tick, GetKey() and
+		// GetMouse() report what was pressed and released since the tick before
+		void SetFixedUpdateRate(float fRate, uint32_t nMaxTicks = 5);
+
+	public: // Frame Pacing
+		// Caps the frame rate at fFPS, 0 for no cap. Frames fall due on a steady
+		// schedule, the engine sleeps until just before each one is due and
+		// spins for the rest, so the cap holds without drifting or busying a core
+		void SetFrameRateLimit(float fFPS);
+		// Mean time between frames and its standard deviation, the jitter, over
+		// the last whole second, in seconds
+		void GetFrameTiming(float &fMean, float &fJitter);
+
+	public: // Presentation
+		// With 2 or 3 buffers, finished frames are handed to a thread of their
+		// own that owns OpenGL and shows them, while the game thread goes on to
+		// the next frame. At most nBuffers - 1 frames wait to be shown, after
+		// that the game thread waits for the window. The screen still keeps its
+		// contents from one frame to the next. 1 shows frames on the game thread,
+		// call it before Start()
+		void SetPresentBuffers(uint32_t nBuffers);
+
+	public: // Parallel Rendering
+		// When enabled, draw calls are queued and later run on nThreads threads
+		// (0 for one per core), each drawing the calls that touch its band of
+		// rows in order. Each call keeps the pixel mode and blend it was made
+		// with. The queue is run when the draw target changes, before Draw() or
+		// an extension draws directly, and at the end of each frame. Sprites
+		// that have been drawn must not change until then, FlushDrawing() runs
+		// the queue at any other time.
+		void EnableParallelRendering(bool bEnable, int32_t nThreads = 0);
+		void FlushDrawing();
+		// Queues draw calls as above even on one thread. Before the queue is run,
+		// calls hidden under later opaque fills and sprites are dropped, calls
+		// that draw the same thing are grouped, and touching fills of the same
+		// colour are merged. Parallel rendering does the same to its queue
+		void EnableDeferredDrawing(bool bEnable);
+		// Calls queued, dropped as hidden, and merged into others in the last
+		// completed frame
+		void GetDrawStats(uint32_t &nQueued, uint32_t &nDropped, uint32_t &nMerged);
+
 	public: // Branding
 		std::string sAppName;
 
@@ -505,6 +793,7 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		Sprite		*pDrawTarget = nullptr;
 		Pixel::Mode	nPixelMode = Pixel::NORMAL;
 		float		fBlendFactor = 1.0f;
+		uint32_t	nBlendFactor = 255;
 		uint32_t	nScreenWidth = 256;
 		uint32_t	nScreenHeight = 240;
 		uint32_t	nPixelWidth = 4;
@@ -531,8 +820,101 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		bool		bEnableVSYNC = false;
 		float		fFrameTimer = 1.0f;
 		int			nFrameCount = 0;
+		float		fFrameLimit = 0.0f;
+		std::chrono::steady_clock::time_point tpFrameDue;
+		std::chrono::steady_clock::duration tOversleep{ 0 };
+		double		dFrameTimeSum = 0.0;
+		double		dFrameTimeSqSum = 0.0;
+		float		fFrameTimeMean = 0.0f;
+		float		fFrameJitter = 0.0f;
 		Sprite		*fontSprite = nullptr;
+		// One bit per pixel of each printable glyph, row j in bits 8j..8j+7
+		uint64_t	nFontGlyphs[96] = {};
 		std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
+		// The custom blend function over a row of n pixels starting at (x,y),
+		// the source advances by nSrcStep per pixel (0 for a single colour)
+		std::function<void(int32_t x, int32_t y, Pixel *pDst, const Pixel *pSrc, int32_t nSrcStep, int32_t n)> funcPixelModeRow;
+
+		struct sRect { int32_t x, y, w, h; };
+		Sprite		*pScrollBackground = nullptr;
+		Sprite		*pScrollTarget = nullptr;
+		int32_t		nScrollX = 0;
+		int32_t		nScrollY = 0;
+		bool		bScrollValid = false;
+		std::vector<sRect> vScrollOverlays;
+
+		bool		bDirtyRects = false;
+		bool		bDirtyOverlay = false;
+		sRect		rDirtyLast = { 0, 0, 0, 0 };
+		std::vector<sRect> vDirtyRects;
+
+		// A queued draw call, which can touch rArea of the draw target. If
+		// bCovers, every pixel of rArea is overwritten. Fills keep their colour
+		// instead of a function, so neighbouring fills can be merged
+		struct sRenderCommand
+		{
+			sRect		rArea;
+			Pixel::Mode	mode;
+			float		fBlend;
+			const void	*pSource;
+			bool		bCovers;
+			bool		bFill;
+			Pixel		fill;
+			std::function<void()> func;
+		};
+		bool		bParallelRender = false;
+		bool		bDeferDraw = false;
+		std::vector<sRenderCommand> vRenderCommands;
+		std::vector<uint32_t> vRenderOrder;
+		uint32_t	nDrawQueued = 0;
+		uint32_t	nDrawDropped = 0;
+		uint32_t	nDrawMerged = 0;
+		// Totals from the last completed frame, for GetDrawStats()
+		uint32_t	nLastDrawQueued = 0;
+		uint32_t	nLastDrawDropped = 0;
+		uint32_t	nLastDrawMerged = 0;
+		std::vector<std::vector<uint32_t>> vRenderBins;
+		std::vector<std::thread> vRenderWorkers;
+		std::mutex	muxRender;
+		std::condition_variable cvRenderWork;
+		std::condition_variable cvRenderDone;
+		uint64_t	nRenderGeneration = 0;
+		int32_t		nRenderActive = 0;
+		bool		bRenderQuit = false;
+		int32_t		nRenderBands = 0;
+		int32_t		nRenderBandHeight = 0;
+		std::atomic<int32_t> nNextRenderBand{ 0 };
+		std::atomic<int32_t> nRenderBandsLeft{ 0 };
+
+		// A finished frame: the screen it was drawn on, the rows that changed
+		// since the frame before, and where and how to show it
+		struct sPresentFrame
+		{
+			Sprite		screen;
+			std::vector<std::pair<int32_t, int32_t>> vRows;
+			std::vector<sRect> vOverlay;
+			int32_t		nViewX = 0, nViewY = 0, nViewW = 0, nViewH = 0;
+			float		fPixelX = 1.0f, fPixelY = 1.0f;
+			float		fOffsetX = 0.0f, fOffsetY = 0.0f;
+			bool		bClear = false;
+		};
+		// Frames change hands through the two counters alone, the mutex is only
+		// for sleeping when there is nothing to do
+		uint32_t	nPresentBuffers = 1;
+		std::thread	tPresenter;
+		std::vector<sPresentFrame> vPresentFrames;
+		std::vector<std::vector<std::pair<int32_t, int32_t>>> vPresentHistory;
+		std::vector<std::pair<int32_t, int32_t>> vPresentCopy;
+		sPresentFrame frameDirect;
+		std::atomic<uint64_t> nFramesSubmitted{ 0 };
+		std::atomic<uint64_t> nFramesPresented{ 0 };
+		std::atomic<int32_t> nPresentSleepers{ 0 };
+		std::atomic<bool> bPresentQuit{ false };
+		std::mutex	muxPresent;
+		std::condition_variable cvPresent;
+		int32_t		nClearWindow = 0;
+		int32_t		nTextureWidth = 0;
+		int32_t		nTextureHeight = 0;
 
 		static std::map<size_t, uint8_t> mapKeys;
 		bool		pKeyNewState[256]{ 0 };
@@ -543,6 +925,16 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		bool		pMouseOldState[5]{ 0 };
 		HWButton	pMouseState[5];
 
+		float		fFixedTick = 0.0f;
+		uint32_t	nMaxFixedTicks = 5;
+		double		dFixedTime = 0.0;
+		bool		bInFixedUpdate = false;
+		// Presses and releases waiting for the next tick, and what a tick sees
+		HWButton	pKeyTickPending[256];
+		HWButton	pKeyTickState[256];
+		HWButton	pMouseTickPending[5];
+		HWButton	pMouseTickState[5];
+
 #ifdef _WIN32
 		HDC			glDeviceContext = nullptr;
 		HGLRC		glRenderContext = nullptr;
@@ -564,8 +956,70 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		void olc_UpdateWindowSize(int32_t x, int32_t y);
 		void olc_UpdateViewport();
 		bool olc_OpenGLCreate();
+		// Waits until the next frame is due when the frame rate is capped
+		void olc_PaceFrame();
+		// Runs the fixed ticks that have fallen due, and says how far the frame
+		// is into the next one. Returns false if a tick asks to quit
+		bool olc_RunFixedUpdates(float fElapsedTime, float &fAlpha);
 		void olc_ConstructFontSheet();
 
+		// Clips a sprite area against the sprite and the draw target, then
+		// copies it row by row in memory order
+		void olc_BlitSprite(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h);
+		// Clips a view against the draw target, then copies it row by row
+		void olc_BlitView(int32_t x, int32_t y, const SpriteView &view);
+		// As olc_BlitSprite, but scaled up by a whole number
+		void olc_BlitSpriteScaled(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale);
+		// As olc_BlitSprite, but scaled by any amount with bilinear filtering
+		void olc_BlitSpriteFiltered(float x, float y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, float scale);
+		// Draws a row of n already clipped pixels at (x,y) with the current pixel mode
+		void olc_DrawRow(Pixel *pDst, const Pixel *pSrc, int32_t n, int32_t x, int32_t y);
+		// Size of a block of text, in pixels
+		void olc_TextExtent(const std::string &sText, uint32_t scale, int32_t &w, int32_t &h);
+		// Draws the lit pixels of text in the current pixel mode
+		void olc_DrawGlyphs(int32_t x, int32_t y, const std::string &sText, Pixel col, uint32_t scale);
+		// Records a changed area of the screen, merging it with its neighbours
+		void olc_MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h);
+		// Creates and destroys OpenGL and the screen texture on the calling thread
+		void olc_PresentStart();
+		void olc_PresentStop();
+		// Records the rows changed this frame and how to show it, then starts
+		// the next set of dirty rectangles
+		void olc_DescribeFrame(sPresentFrame &f);
+		// Uploads the changed rows of a screen to the texture and shows it
+		void olc_PresentFrame(Sprite *pScreen, const sPresentFrame &f);
+		// Hands the finished screen to the presenter thread, and takes back one
+		// it is done with, brought up to date
+		void olc_SubmitFrame();
+		// The presenter thread's side: waits for the next frame, nullptr once
+		// stopped, then hands it back when shown
+		sPresentFrame* olc_NextPresentFrame();
+		void olc_FramePresented();
+		void olc_PresentThread();
+		void olc_PresentWait(const std::function<bool()> &ready);
+		void olc_PresentNotify();
+		// Draws a horizontal run of w pixels of one colour, clipped to the draw target
+		void olc_DrawSpan(int32_t x, int32_t y, int32_t w, Pixel p);
+		// Queues a draw call that can touch the area (x,y,w,h) if draw calls are
+		// being queued, returns false if it has to be drawn straight away instead.
+		// pSource is what it draws, bCovers if it overwrites the whole area
+		bool olc_Defer(int32_t x, int32_t y, int32_t w, int32_t h, std::function<void()> func, const void *pSource = nullptr, bool bCovers = false);
+		bool olc_DeferFill(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p);
+		bool olc_QueueCommand(sRenderCommand cmd);
+		void olc_OptimiseCommands();
+		void olc_RunCommand(const sRenderCommand &cmd);
+		void olc_RunBands(size_t a, size_t b);
+		// Runs the queued draw calls, a band at a time on every render thread
+		void olc_FlushCommands();
+		void olc_RenderBands();
+		void olc_RenderWorker();
+#ifdef OLC_DBG_BLIT
+		// Redraws a blit through Draw() and reports where the fast path disagrees
+		void olc_DbgVerifyBlit(int32_t x, int32_t y, int32_t w, int32_t h, const Pixel *pSrc, int32_t nSrcStride, const std::vector<Pixel> &vUnder);
+#endif
+
+		// Extensions get at the row kernels through PGEX
+		friend class PGEX;
 
 #ifdef _WIN32
 		// Windows specific window handling
@@ -592,9 +1046,27 @@ namespace olc // All OneLoneCoder stuff will now exist in the "olc" namespace
 		friend class olc::PixelGameEngine;
 	protected:
 		static PixelGameEngine* pge;
+		// Draws a row of n pixels with the current pixel mode, the whole row
+		// (x,y) to (x+n-1,y) must already be clipped to the draw target
+		static void DrawRow(int32_t x, int32_t y, const Pixel *pSrc, int32_t n);
 	};
 
 	//=============================================================
+
+	template<typename F>
+	void PixelGameEngine::SetPixelMode(F pixelMode)
+	{
+		FlushDrawing();
+		funcPixelMode = pixelMode;
+		funcPixelModeRow = [pixelMode](int32_t x, int32_t y, Pixel *pDst, const Pixel *pSrc, int32_t nSrcStep, int32_t n) mutable
+		{
+			for (int32_t i = 0; i < n; i++, pSrc += nSrcStep)
+				pDst[i] = pixelMode(x + i, y, *pSrc, pDst[i]);
+		};
+		nPixelMode = Pixel::Mode::CUSTOM;
+	}
+
+	//=============================================================
 }
 
 
@@ -683,28 +1155,78 @@ namespace olc
 
 	Sprite::Sprite(int32_t w, int32_t h)
 	{
-		if(pColData) delete[] pColData;
-		width = w;		height = h;
-		pColData = new Pixel[width * height];
-		for (int32_t i = 0; i < width*height; i++)
-			pColData[i] = Pixel();
+		Allocate(w, h);
+		for (int32_t y = 0; y < height; y++)
+			std::fill_n(GetRow(y), width, Pixel());
+	}
+
+	Sprite::Sprite(Sprite &&sprite)
+	{
+		*this = std::move(sprite);
+	}
+
+	Sprite& Sprite::operator=(Sprite &&sprite)
+	{
+		if (this != &sprite)
+		{
+			Free();
+			width = sprite.width; height = sprite.height;
+			pColData = sprite.pColData; nStride = sprite.nStride;
+			modeSample = sprite.modeSample; bPremultiplied = sprite.bPremultiplied;
+			sprite.pColData = nullptr;
+			sprite.width = 0; sprite.height = 0; sprite.nStride = 0;
+		}
+		return *this;
 	}
 
 	Sprite::~Sprite()
 	{
-		if (pColData) delete pColData;
+		Free();
+	}
+
+	void Sprite::Allocate(int32_t w, int32_t h)
+	{
+		Free();
+		if (w <= 0 || h <= 0) return;
+
+		// Rows are padded to 8 pixels, the array is aligned to 64 bytes
+		width = w; height = h;
+		nStride = (w + 7) & ~7;
+		const size_t nBytes = (size_t)nStride * h * sizeof(Pixel);
+#ifdef _WIN32
+		pColData = (Pixel*)_aligned_malloc(nBytes, 64);
+#else
+		void *p = nullptr;
+		pColData = posix_memalign(&p, 64, nBytes) == 0 ? (Pixel*)p : nullptr;
+#endif
+		if (pColData == nullptr) { width = 0; height = 0; nStride = 0; }
+	}
+
+	void Sprite::Free()
+	{
+#ifdef _WIN32
+		_aligned_free(pColData);
+#else
+		free(pColData);
+#endif
+		pColData = nullptr;
+		width = 0; height = 0; nStride = 0;
+		bPremultiplied = false;
 	}
 
 	olc::rcode Sprite::LoadFromPGESprFile(std::string sImageFile, olc::ResourcePack *pack)
 	{
-		if (pColData) delete[] pColData;
+		Free();
 
+		// The file holds rows packed together, they are read into padded rows
 		auto ReadData = [&](std::istream &is)
 		{
-			is.read((char*)&width, sizeof(int32_t));
-			is.read((char*)&height, sizeof(int32_t));
-			pColData = new Pixel[width * height];
-			is.read((char*)pColData, width * height * sizeof(uint32_t));
+			int32_t w = 0, h = 0;
+			is.read((char*)&w, sizeof(int32_t));
+			is.read((char*)&h, sizeof(int32_t));
+			Allocate(w, h);
+			for (int32_t y = 0; y < height; y++)
+				is.read((char*)GetRow(y), width * sizeof(uint32_t));
 		};
 
 		// These are essentially Memory Surfaces represented by olc::Sprite
@@ -742,7 +1264,8 @@ namespace olc
 		{
 			ofs.write((char*)&width, sizeof(int32_t));
 			ofs.write((char*)&height, sizeof(int32_t));
-			ofs.write((char*)pColData, width*height*sizeof(uint32_t));
+			for (int32_t y = 0; y < height; y++)
+				ofs.write((char*)GetRow(y), width * sizeof(uint32_t));
 			ofs.close();
 			return olc::OK;
 		}
@@ -768,9 +1291,7 @@ namespace olc
 		if (bmp == nullptr)
 			return olc::NO_FILE;
 
-		width = bmp->GetWidth();
-		height = bmp->GetHeight();
-		pColData = new Pixel[width * height];
+		Allocate(bmp->GetWidth(), bmp->GetHeight());
 
 		for(int x=0; x<width; x++)
 			for (int y = 0; y < height; y++)
@@ -805,6 +1326,7 @@ namespace olc
 		png_byte color_type;
 		png_byte bit_depth;
 		png_bytep *row_pointers;
+		Free();
 		width = png_get_image_width(png, info);
 		height = png_get_image_height(png, info);
 		color_type = png_get_color_type(png, info);
@@ -836,7 +1358,7 @@ namespace olc
 		////////////////////////////////////////////////////////////////////////////
 
 		// Create sprite array
-		pColData = new Pixel[width * height];
+		Allocate(width, height);
 
 		// Iterate through image rows, converting into sprite format
 		for (int y = 0; y < height; y++)
@@ -853,10 +1375,8 @@ namespace olc
 		return olc::OK;
 
 	fail_load:
-		width = 0;
-		height = 0;
+		Free();
 		fclose(f);
-		pColData = nullptr;
 		return olc::FAIL;
 #endif
 	}
@@ -866,19 +1386,24 @@ namespace olc
 		modeSample = mode;
 	}
 
+	olc::Sprite::Mode Sprite::GetSampleMode()
+	{
+		return modeSample;
+	}
+
 
 	Pixel Sprite::GetPixel(int32_t x, int32_t y)
 	{
 		if (modeSample == olc::Sprite::Mode::NORMAL)
 		{
 			if (x >= 0 && x < width && y >= 0 && y < height)
-				return pColData[y*width + x];
+				return pColData[y*nStride + x];
 			else
 				return Pixel(0, 0, 0, 0);
 		}
 		else
 		{
-			return pColData[abs(y%height)*width + abs(x%width)];
+			return pColData[abs(y%height)*nStride + abs(x%width)];
 		}
 	}
 
@@ -891,13 +1416,109 @@ namespace olc
 
 		if (x >= 0 && x < width && y >= 0 && y < height)
 		{
-			pColData[y*width + x] = p;
+			pColData[y*nStride + x] = p;
 			return true;
 		}
 		else
 			return false;
 	}
 
+	// Texel addressing for the bilinear filter, mapping any column or row onto
+	// the area that starts at lo and is n long without branching per texel
+	struct olc_AddrClamp
+	{
+		int32_t lo, hi;
+		olc_AddrClamp(int32_t l, int32_t n) : lo(l), hi(l + n - 1) {}
+		inline int32_t operator()(int32_t i) const { return std::min(std::max(i, lo), hi); }
+	};
+
+	struct olc_AddrWrap
+	{
+		int32_t lo, n;
+		olc_AddrWrap(int32_t l, int32_t n) : lo(l), n(n) {}
+		inline int32_t operator()(int32_t i) const { return lo + ((i - lo) % n + n) % n; }
+	};
+
+	struct olc_AddrWrapPow2
+	{
+		int32_t lo, mask;
+		olc_AddrWrapPow2(int32_t l, int32_t n) : lo(l), mask(n - 1) {}
+		inline int32_t operator()(int32_t i) const { return lo + ((i - lo) & mask); }
+	};
+
+	// Bilinear samples along a line, positions in 16.16 fixed point with texel
+	// centres on whole numbers. Weights are 8 bit, so a channel is blended as
+	// (a * (256 - f) + b * f) >> 8, which stays within 16 bits
+	template<typename AX, typename AY>
+	static void olc_SampleRowBL(const Pixel *pData, int32_t nStride, AX ax, AY ay, int32_t u, int32_t v, int32_t du, int32_t dv, Pixel *pDst, int32_t n)
+	{
+		int32_t i = 0;
+#ifdef OLC_SIMD_SSE2
+		const __m128i zero = _mm_setzero_si128(), w256 = _mm_set1_epi16(256);
+		// Blends two pixels per register, each spread over four 16 bit lanes
+		auto Blend2 = [&](const uint32_t *t, int32_t fx0, int32_t fy0, int32_t fx1, int32_t fy1)
+		{
+			const __m128i p00 = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, t[4], t[0]), zero);
+			const __m128i p10 = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, t[5], t[1]), zero);
+			const __m128i p01 = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, t[6], t[2]), zero);
+			const __m128i p11 = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, t[7], t[3]), zero);
+			const __m128i fx = _mm_set_epi16(fx1, fx1, fx1, fx1, fx0, fx0, fx0, fx0);
+			const __m128i fy = _mm_set_epi16(fy1, fy1, fy1, fy1, fy0, fy0, fy0, fy0);
+			const __m128i ifx = _mm_sub_epi16(w256, fx), ify = _mm_sub_epi16(w256, fy);
+			const __m128i top = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(p00, ifx), _mm_mullo_epi16(p10, fx)), 8);
+			const __m128i bot = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(p01, ifx), _mm_mullo_epi16(p11, fx)), 8);
+			return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(top, ify), _mm_mullo_epi16(bot, fy)), 8);
+		};
+
+		for (; i + 4 <= n; i += 4)
+		{
+			uint32_t t[16];
+			int32_t fx[4], fy[4];
+			for (int k = 0; k < 4; k++, u += du, v += dv)
+			{
+				const int32_t tx = u >> 16, ty = v >> 16;
+				const int32_t x0 = ax(tx), x1 = ax(tx + 1), y0 = ay(ty) * nStride, y1 = ay(ty + 1) * nStride;
+				t[k * 4 + 0] = pData[y0 + x0].n; t[k * 4 + 1] = pData[y0 + x1].n;
+				t[k * 4 + 2] = pData[y1 + x0].n; t[k * 4 + 3] = pData[y1 + x1].n;
+				fx[k] = (u >> 8) & 0xFF; fy[k] = (v >> 8) & 0xFF;
+			}
+			const __m128i a = Blend2(t, fx[0], fy[0], fx[1], fy[1]);
+			const __m128i b = Blend2(t + 8, fx[2], fy[2], fx[3], fy[3]);
+			_mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(a, b));
+		}
+#endif
+		for (; i < n; i++, u += du, v += dv)
+		{
+			const int32_t tx = u >> 16, ty = v >> 16;
+			const int32_t x0 = ax(tx), x1 = ax(tx + 1), y0 = ay(ty) * nStride, y1 = ay(ty + 1) * nStride;
+			const int32_t fx = (u >> 8) & 0xFF, fy = (v >> 8) & 0xFF;
+			const uint8_t *p00 = (const uint8_t*)&pData[y0 + x0], *p10 = (const uint8_t*)&pData[y0 + x1];
+			const uint8_t *p01 = (const uint8_t*)&pData[y1 + x0], *p11 = (const uint8_t*)&pData[y1 + x1];
+			uint8_t *d = (uint8_t*)&pDst[i];
+			for (int c = 0; c < 4; c++)
+			{
+				const int32_t top = (p00[c] * (256 - fx) + p10[c] * fx) >> 8;
+				const int32_t bot = (p01[c] * (256 - fx) + p11[c] * fx) >> 8;
+				d[c] = (uint8_t)((top * (256 - fy) + bot * fy) >> 8);
+			}
+		}
+	}
+
+	// Picks the addressing for the area (ox,oy) to (ox+w,oy+h) once per row
+	static void olc_SampleRowBL(const Pixel *pData, int32_t nStride, int32_t ox, int32_t oy, int32_t w, int32_t h, bool bWrap,
+		float x, float y, float dx, float dy, Pixel *pDst, int32_t n)
+	{
+		if (n <= 0 || w <= 0 || h <= 0) return;
+		const int32_t u = (int32_t)std::floor((x - 0.5f) * 65536.0f), v = (int32_t)std::floor((y - 0.5f) * 65536.0f);
+		const int32_t du = (int32_t)std::floor(dx * 65536.0f), dv = (int32_t)std::floor(dy * 65536.0f);
+		if (!bWrap)
+			olc_SampleRowBL(pData, nStride, olc_AddrClamp(ox, w), olc_AddrClamp(oy, h), u, v, du, dv, pDst, n);
+		else if ((w & (w - 1)) == 0 && (h & (h - 1)) == 0)
+			olc_SampleRowBL(pData, nStride, olc_AddrWrapPow2(ox, w), olc_AddrWrapPow2(oy, h), u, v, du, dv, pDst, n);
+		else
+			olc_SampleRowBL(pData, nStride, olc_AddrWrap(ox, w), olc_AddrWrap(oy, h), u, v, du, dv, pDst, n);
+	}
+
 	Pixel Sprite::Sample(float x, float y)
 	{
 		int32_t sx = std::min((int32_t)((x * (float)width)), width - 1);
@@ -907,765 +1528,2703 @@ namespace olc
 
 	Pixel Sprite::SampleBL(float u, float v)
 	{
-		u = u * width - 0.5f;
-		v = v * height - 0.5f;
-		int x = (int)floor(u); // cast to int rounds toward zero, not downward
-		int y = (int)floor(v); // Thanks @joshinils
-		float u_ratio = u - x;
-		float v_ratio = v - y;
-		float u_opposite = 1 - u_ratio;
-		float v_opposite = 1 - v_ratio;
-
-		olc::Pixel p1 = GetPixel(std::max(x, 0), std::max(y, 0));
-		olc::Pixel p2 = GetPixel(std::min(x + 1, (int)width - 1), std::max(y, 0));
-		olc::Pixel p3 = GetPixel(std::max(x, 0), std::min(y + 1, (int)height - 1));
-		olc::Pixel p4 = GetPixel(std::min(x + 1, (int)width - 1), std::min(y + 1, (int)height - 1));
+		Pixel p(0, 0, 0, 0);
+		SampleRowBL(u * width, v * height, 0.0f, 0.0f, &p, 1);
+		return p;
+	}
 
-		return olc::Pixel(
-			(uint8_t)((p1.r * u_opposite + p2.r * u_ratio) * v_opposite + (p3.r * u_opposite + p4.r * u_ratio) * v_ratio),
-			(uint8_t)((p1.g * u_opposite + p2.g * u_ratio) * v_opposite + (p3.g * u_opposite + p4.g * u_ratio) * v_ratio),
-			(uint8_t)((p1.b * u_opposite + p2.b * u_ratio) * v_opposite + (p3.b * u_opposite + p4.b * u_ratio) * v_ratio));
+	void Sprite::SampleRowBL(float x, float y, float dx, float dy, Pixel *pDst, int32_t n)
+	{
+		if (pColData == nullptr) return;
+		olc_SampleRowBL(pColData, nStride, 0, 0, width, height, modeSample == Mode::PERIODIC, x, y, dx, dy, pDst, n);
 	}
 
 	Pixel* Sprite::GetData() { return pColData; }
 
+	int32_t Sprite::GetStride() const { return nStride; }
+
+	Pixel* Sprite::GetRow(int32_t y) { return pColData + y * nStride; }
+
+	void Sprite::Premultiply()
+	{
+		if (bPremultiplied || pColData == nullptr) return;
+
+		for (int32_t y = 0; y < height; y++)
+			for (int32_t x = 0; x < width; x++)
+			{
+				Pixel &p = pColData[y * nStride + x];
+				p.r = (uint8_t)((p.r * p.a + 127) / 255);
+				p.g = (uint8_t)((p.g * p.a + 127) / 255);
+				p.b = (uint8_t)((p.b * p.a + 127) / 255);
+			}
+		bPremultiplied = true;
+	}
+
+	bool Sprite::IsPremultiplied()
+	{
+		return bPremultiplied;
+	}
+
 	//==========================================================
 
-	ResourcePack::ResourcePack()
+	SpriteView::SpriteView()
 	{
+	}
 
+	SpriteView::SpriteView(Sprite *sprite) : SpriteView(sprite, 0, 0, sprite ? sprite->width : 0, sprite ? sprite->height : 0)
+	{
 	}
 
-	ResourcePack::~ResourcePack()
+	SpriteView::SpriteView(Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h)
 	{
-		ClearPack();
+		if (sprite == nullptr || sprite->GetData() == nullptr) return;
+		const int32_t x1 = std::max(ox, 0), y1 = std::max(oy, 0);
+		const int32_t x2 = std::min(ox + w, sprite->width), y2 = std::min(oy + h, sprite->height);
+		if (x1 >= x2 || y1 >= y2) return;
+
+		pSprite = sprite;
+		pData = sprite->GetRow(y1) + x1;
+		nStride = sprite->GetStride();
+		width = x2 - x1;
+		height = y2 - y1;
 	}
 
-	olc::rcode ResourcePack::AddToPack(std::string sFile)
+	Pixel SpriteView::GetPixel(int32_t x, int32_t y) const
 	{
-		std::ifstream ifs(sFile, std::ifstream::binary);
-		if (!ifs.is_open()) return olc::FAIL;
+		if (x >= 0 && x < width && y >= 0 && y < height)
+			return pData[y * nStride + x];
+		else
+			return Pixel(0, 0, 0, 0);
+	}
 
-		// Get File Size
-		std::streampos p = 0;
-		p = ifs.tellg();
-		ifs.seekg(0, std::ios::end);
-		p = ifs.tellg() - p;
-		ifs.seekg(0, std::ios::beg);
+	Pixel* SpriteView::GetData() const { return pData; }
 
-		// Create entry
-		sEntry e;
-		e.data = nullptr;
-		e.nFileSize = (uint32_t)p;
+	Pixel* SpriteView::GetRow(int32_t y) const { return pData + y * nStride; }
 
-		// Read file into memory
-		e.data = new uint8_t[(uint32_t)e.nFileSize];
-		ifs.read((char*)e.data, e.nFileSize);
-		ifs.close();
+	int32_t SpriteView::GetStride() const { return nStride; }
 
-		// Add To Map
-		mapFiles[sFile] = e;
-		return olc::OK;
+	Sprite* SpriteView::GetSprite() const { return pSprite; }
+
+	SpriteView SpriteView::SubView(int32_t ox, int32_t oy, int32_t w, int32_t h) const
+	{
+		SpriteView v;
+		const int32_t x1 = std::max(ox, 0), y1 = std::max(oy, 0);
+		const int32_t x2 = std::min(ox + w, width), y2 = std::min(oy + h, height);
+		if (pData == nullptr || x1 >= x2 || y1 >= y2) return v;
+
+		v.pSprite = pSprite;
+		v.pData = GetRow(y1) + x1;
+		v.nStride = nStride;
+		v.width = x2 - x1;
+		v.height = y2 - y1;
+		return v;
 	}
 
-	olc::rcode ResourcePack::SavePack(std::string sFile)
+	//==========================================================
+
+	CompiledSprite::CompiledSprite()
 	{
-		std::ofstream ofs(sFile, std::ofstream::binary);
-		if (!ofs.is_open()) return olc::FAIL;
+	}
 
-		// 1) Write Map
-		size_t nMapSize = mapFiles.size();
-		ofs.write((char*)&nMapSize, sizeof(size_t));
-		for (auto &e : mapFiles)
-		{
-			size_t nPathSize = e.first.size();
-			ofs.write((char*)&nPathSize, sizeof(size_t));
-			ofs.write(e.first.c_str(), nPathSize);
-			ofs.write((char*)&e.second.nID, sizeof(uint32_t));
-			ofs.write((char*)&e.second.nFileSize, sizeof(uint32_t));
-			ofs.write((char*)&e.second.nFileOffset, sizeof(uint32_t));
-		}
+	CompiledSprite::CompiledSprite(Sprite *sprite)
+	{
+		Compile(sprite);
+	}
 
-		// 2) Write Data
-		std::streampos offset = ofs.tellp();
-		for (auto &e : mapFiles)
-		{
-			e.second.nFileOffset = (uint32_t)offset;
-			ofs.write((char*)e.second.data, e.second.nFileSize);
-			offset += e.second.nFileSize;
-		}
+	CompiledSprite::CompiledSprite(TiledSprite *sprite)
+	{
+		Compile(sprite);
+	}
 
-		// 3) Rewrite Map (it has been updated with offsets now)
-		ofs.seekp(std::ios::beg);
-		ofs.write((char*)&nMapSize, sizeof(size_t));
-		for (auto &e : mapFiles)
-		{
-			size_t nPathSize = e.first.size();
-			ofs.write((char*)&nPathSize, sizeof(size_t));
-			ofs.write(e.first.c_str(), nPathSize);
-			ofs.write((char*)&e.second.nID, sizeof(uint32_t));
-			ofs.write((char*)&e.second.nFileSize, sizeof(uint32_t));
-			ofs.write((char*)&e.second.nFileOffset, sizeof(uint32_t));
-		}
-		ofs.close();
+	olc::rcode CompiledSprite::Compile(Sprite *sprite)
+	{
+		vRuns.clear(); vPixels.clear(); vRowRuns.clear(); vRowPixels.clear();
+		width = 0; height = 0;
+		if (sprite == nullptr || sprite->GetData() == nullptr || sprite->width > 0xFFFF)
+			return olc::FAIL;
+
+		width = sprite->width;
+		height = sprite->height;
+
+		for (int32_t y = 0; y < height; y++)
+			CompileRow(sprite->GetRow(y));
 
+		vRowRuns.push_back((uint32_t)vRuns.size());
+		vRowPixels.push_back((uint32_t)vPixels.size());
 		return olc::OK;
 	}
 
-	olc::rcode ResourcePack::LoadPack(std::string sFile)
+	olc::rcode CompiledSprite::Compile(TiledSprite *sprite)
 	{
-		std::ifstream ifs(sFile, std::ifstream::binary);
-		if (!ifs.is_open()) return olc::FAIL;
+		vRuns.clear(); vPixels.clear(); vRowRuns.clear(); vRowPixels.clear();
+		width = 0; height = 0;
+		if (sprite == nullptr || sprite->width == 0 || sprite->width > 0xFFFF)
+			return olc::FAIL;
 
-		// 1) Read Map
-		uint32_t nMapEntries;
-		ifs.read((char*)&nMapEntries, sizeof(uint32_t));
-		for (uint32_t i = 0; i < nMapEntries; i++)
+		width = sprite->width;
+		height = sprite->height;
+
+		std::vector<Pixel> vRow(width);
+		for (int32_t y = 0; y < height; y++)
 		{
-			uint32_t nFilePathSize = 0;
-			ifs.read((char*)&nFilePathSize, sizeof(uint32_t));
+			sprite->GetRow(y, vRow.data());
+			CompileRow(vRow.data());
+		}
 
-			std::string sFileName(nFilePathSize, ' ');
-			for (uint32_t j = 0; j < nFilePathSize; j++)
-				sFileName[j] = ifs.get();
+		vRowRuns.push_back((uint32_t)vRuns.size());
+		vRowPixels.push_back((uint32_t)vPixels.size());
+		return olc::OK;
+	}
 
-			sEntry e;
-			e.data = nullptr;
-			ifs.read((char*)&e.nID, sizeof(uint32_t));
-			ifs.read((char*)&e.nFileSize, sizeof(uint32_t));
-			ifs.read((char*)&e.nFileOffset, sizeof(uint32_t));
-			mapFiles[sFileName] = e;
-		}
+	void CompiledSprite::CompileRow(const Pixel *pRow)
+	{
+		vRowRuns.push_back((uint32_t)vRuns.size());
+		vRowPixels.push_back((uint32_t)vPixels.size());
 
-		// 2) Read Data
-		for (auto &e : mapFiles)
+		int32_t x = 0;
+		while (x < width)
 		{
-			e.second.data = new uint8_t[(uint32_t)e.second.nFileSize];
-			ifs.seekg(e.second.nFileOffset);
-			ifs.read((char*)e.second.data, e.second.nFileSize);
-			e.second._config();
+			sRun run = { 0, 0, 0 };
+			while (x < width && pRow[x].a == 0) { run.nSkip++; x++; }
+			while (x < width && pRow[x].a == 255) { vPixels.push_back(pRow[x]); run.nCopy++; x++; }
+			while (x < width && pRow[x].a != 0 && pRow[x].a != 255) { vPixels.push_back(pRow[x]); run.nBlend++; x++; }
+
+			// Trailing transparency needs no run at all
+			if (run.nCopy + run.nBlend > 0)
+				vRuns.push_back(run);
 		}
-
-		ifs.close();
-		return olc::OK;
 	}
 
-	olc::ResourcePack::sEntry ResourcePack::GetStreamBuffer(std::string sFile)
+	//==========================================================
+
+	TiledSprite::TiledSprite()
 	{
-		return mapFiles[sFile];
 	}
 
-	olc::rcode ResourcePack::ClearPack()
+	TiledSprite::TiledSprite(std::string sImageFile, olc::ResourcePack *pack)
 	{
-		for (auto &e : mapFiles)
-		{
-			if (e.second.data != nullptr)
-				delete[] e.second.data;
-		}
-
-		mapFiles.clear();
-		return olc::OK;
+		LoadFromFile(sImageFile, pack);
 	}
 
-	//==========================================================
+	TiledSprite::TiledSprite(Sprite *sprite, int32_t nTileSize)
+	{
+		Build(sprite, nTileSize);
+	}
 
-	PixelGameEngine::PixelGameEngine()
+	olc::rcode TiledSprite::LoadFromFile(std::string sImageFile, olc::ResourcePack *pack)
 	{
-		sAppName = "Undefined";
-		olc::PGEX::pge = this;
+		// The full image only lives long enough to be split up
+		Sprite image;
+		if (image.LoadFromFile(sImageFile, pack) != olc::OK)
+			return olc::NO_FILE;
+		return Build(&image, nTileSize);
 	}
 
-	olc::rcode PixelGameEngine::Construct(uint32_t screen_w, uint32_t screen_h, uint32_t pixel_w, uint32_t pixel_h, bool full_screen, bool vsync)
+	olc::rcode TiledSprite::Build(Sprite *sprite, int32_t nTileSize)
 	{
-		nScreenWidth = screen_w;
-		nScreenHeight = screen_h;
-		nPixelWidth = pixel_w;
-		nPixelHeight = pixel_h;
-		bFullScreen = full_screen;
-		bEnableVSYNC = vsync;
+		vTiles.clear(); vTileset.clear();
+		width = 0; height = 0; nTilesX = 0; nTilesY = 0;
+		if (sprite == nullptr || sprite->GetData() == nullptr || nTileSize <= 0)
+			return olc::FAIL;
 
-		fPixelX = 2.0f / (float)(nScreenWidth);
-		fPixelY = 2.0f / (float)(nScreenHeight);
+		this->nTileSize = nTileSize;
+		width = sprite->width;
+		height = sprite->height;
+		nTilesX = (width + nTileSize - 1) / nTileSize;
+		nTilesY = (height + nTileSize - 1) / nTileSize;
+		vTiles.resize(nTilesX * nTilesY);
 
-		if (nPixelWidth == 0 || nPixelHeight == 0 || nScreenWidth == 0 || nScreenHeight == 0)
-			return olc::FAIL;
+		// Stored tiles by a hash of their contents, to find duplicates
+		std::multimap<uint64_t, uint32_t> mapStored;
+		const int32_t nTilePixels = nTileSize * nTileSize;
+		std::vector<Pixel> vTile(nTilePixels);
 
-#ifdef _WIN32
-#ifdef UNICODE
-#ifndef __MINGW32__
-		wsAppName = ConvertS2W(sAppName);
-#endif
-#endif
-#endif
-		// Load the default font sheet
-		olc_ConstructFontSheet();
+		for (int32_t ty = 0; ty < nTilesY; ty++)
+			for (int32_t tx = 0; tx < nTilesX; tx++)
+			{
+				const int32_t w = std::min(nTileSize, width - tx * nTileSize);
+				const int32_t h = std::min(nTileSize, height - ty * nTileSize);
 
-		// Create a sprite that represents the primary drawing target
-		pDefaultDrawTarget = new Sprite(nScreenWidth, nScreenHeight);
-		SetDrawTarget(nullptr);
-		return olc::OK;
-	}
+				std::fill(vTile.begin(), vTile.end(), olc::BLANK);
+				for (int32_t j = 0; j < h; j++)
+				{
+					const Pixel *pSrc = sprite->GetRow(ty * nTileSize + j) + tx * nTileSize;
+					for (int32_t i = 0; i < w; i++)
+						vTile[j * nTileSize + i] = pSrc[i].a == 0 ? olc::BLANK : pSrc[i];
+				}
 
+				bool bUniform = true;
+				for (int32_t j = 0; j < h && bUniform; j++)
+					for (int32_t i = 0; i < w && bUniform; i++)
+						bUniform = vTile[j * nTileSize + i] == vTile[0];
 
-	void PixelGameEngine::SetScreenSize(int w, int h)
-	{
-		delete pDefaultDrawTarget;
-		nScreenWidth = w;
-		nScreenHeight = h;
-		pDefaultDrawTarget = new Sprite(nScreenWidth, nScreenHeight);
-		SetDrawTarget(nullptr);
-		glClear(GL_COLOR_BUFFER_BIT);
-#ifdef _WIN32
-		SwapBuffers(glDeviceContext);
-#else
-		glXSwapBuffers(olc_Display, olc_Window);
-#endif
-		glClear(GL_COLOR_BUFFER_BIT);
-		olc_UpdateViewport();
-	}
+				sTile &tile = vTiles[ty * nTilesX + tx];
+				tile.colour = vTile[0];
+				tile.nIndex = 0;
+				if (bUniform)
+				{
+					tile.nKind = vTile[0].a == 0 ? EMPTY : UNIFORM;
+					continue;
+				}
 
-	olc::rcode PixelGameEngine::Start()
-	{
-		// Construct the window
-		if (!olc_WindowCreate())
-			return olc::FAIL;
+				// FNV-1a over the tile
+				uint64_t nHash = 14695981039346656037ULL;
+				for (auto &p : vTile)
+					nHash = (nHash ^ p.n) * 1099511628211ULL;
 
-		// Load libraries required for PNG file interaction
-//#ifdef _WIN32
-//		// Windows use GDI+
-//		Gdiplus::GdiplusStartupInput startupInput;
-//		ULONG_PTR			token;
-//		Gdiplus::GdiplusStartup(&token, &startupInput, NULL);
-//#else
-//		// Linux use libpng
-//
-//#endif
-		// Start the thread
-		bAtomActive = true;
-		std::thread t = std::thread(&PixelGameEngine::EngineThread, this);
+				tile.nKind = STORED;
+				tile.nIndex = (uint32_t)(vTileset.size() / nTilePixels);
+				auto range = mapStored.equal_range(nHash);
+				for (auto it = range.first; it != range.second; ++it)
+					if (memcmp(&vTileset[it->second * nTilePixels], vTile.data(), nTilePixels * sizeof(Pixel)) == 0)
+					{
+						tile.nIndex = it->second;
+						break;
+					}
 
-#ifdef _WIN32
-		// Handle Windows Message Loop
-		MSG msg;
-		while (GetMessage(&msg, NULL, 0, 0) > 0)
-		{
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
-		}
-#endif
+				if (tile.nIndex == vTileset.size() / nTilePixels)
+				{
+					mapStored.insert({ nHash, tile.nIndex });
+					vTileset.insert(vTileset.end(), vTile.begin(), vTile.end());
+				}
+			}
 
-		// Wait for thread to be exited
-		t.join();
 		return olc::OK;
 	}
 
-	void PixelGameEngine::SetDrawTarget(Sprite *target)
+	Pixel TiledSprite::GetPixel(int32_t x, int32_t y)
 	{
-		if (target)
-			pDrawTarget = target;
-		else
-			pDrawTarget = pDefaultDrawTarget;
-	}
+		if (x < 0 || y < 0 || x >= width || y >= height)
+			return olc::BLANK;
 
-	Sprite* PixelGameEngine::GetDrawTarget()
-	{
-		return pDrawTarget;
+		const sTile &tile = vTiles[(y / nTileSize) * nTilesX + x / nTileSize];
+		if (tile.nKind != STORED)
+			return tile.colour;
+		return vTileset[(tile.nIndex * nTileSize + y % nTileSize) * nTileSize + x % nTileSize];
 	}
 
-	int32_t PixelGameEngine::GetDrawTargetWidth()
+	void TiledSprite::GetRow(int32_t y, Pixel *pRow)
 	{
-		if (pDrawTarget)
-			return pDrawTarget->width;
-		else
-			return 0;
-	}
+		if (y < 0 || y >= height)
+			return;
 
-	int32_t PixelGameEngine::GetDrawTargetHeight()
-	{
-		if (pDrawTarget)
-			return pDrawTarget->height;
-		else
-			return 0;
+		const int32_t ty = y / nTileSize;
+		for (int32_t tx = 0; tx < nTilesX; tx++)
+		{
+			const sTile &tile = vTiles[ty * nTilesX + tx];
+			const int32_t w = std::min(nTileSize, width - tx * nTileSize);
+			Pixel *pDst = pRow + tx * nTileSize;
+			if (tile.nKind == STORED)
+				memcpy(pDst, &vTileset[(tile.nIndex * nTileSize + y % nTileSize) * nTileSize], w * sizeof(Pixel));
+			else
+				std::fill_n(pDst, w, tile.colour);
+		}
 	}
 
-	bool PixelGameEngine::IsFocused()
+	size_t TiledSprite::GetMemoryUsage()
 	{
-		return bHasInputFocus;
+		return vTiles.size() * sizeof(sTile) + vTileset.size() * sizeof(Pixel);
 	}
 
-	HWButton PixelGameEngine::GetKey(Key k)
-	{
-		return pKeyboardState[k];
-	}
+	//==========================================================
 
-	HWButton PixelGameEngine::GetMouse(uint32_t b)
+	TextLabel::TextLabel()
 	{
-		return pMouseState[b];
 	}
 
-	int32_t PixelGameEngine::GetMouseX()
+	TextLabel::~TextLabel()
 	{
-		return nMousePosX;
+		delete pSprite;
 	}
 
-	int32_t PixelGameEngine::GetMouseY()
+	const std::string &TextLabel::GetText()
 	{
-		return nMousePosY;
+		return sText;
 	}
 
-	int32_t PixelGameEngine::GetMouseWheel()
-	{
-		return nMouseWheelDelta;
-	}
+	//==========================================================
 
-	int32_t PixelGameEngine::ScreenWidth()
+	ResourcePack::ResourcePack()
 	{
-		return nScreenWidth;
+
 	}
 
-	int32_t PixelGameEngine::ScreenHeight()
+	ResourcePack::~ResourcePack()
 	{
-		return nScreenHeight;
+		ClearPack();
 	}
 
-	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
+	olc::rcode ResourcePack::AddToPack(std::string sFile)
 	{
-		if (!pDrawTarget) return false;
+		std::ifstream ifs(sFile, std::ifstream::binary);
+		if (!ifs.is_open()) return olc::FAIL;
 
+		// Get File Size
+		std::streampos p = 0;
+		p = ifs.tellg();
+		ifs.seekg(0, std::ios::end);
+		p = ifs.tellg() - p;
+		ifs.seekg(0, std::ios::beg);
 
-		if (nPixelMode == Pixel::NORMAL)
-		{
-			return pDrawTarget->SetPixel(x, y, p);
-		}
+		// Create entry
+		sEntry e;
+		e.data = nullptr;
+		e.nFileSize = (uint32_t)p;
 
-		if (nPixelMode == Pixel::MASK)
+		// Read file into memory
+		e.data = new uint8_t[(uint32_t)e.nFileSize];
+		ifs.read((char*)e.data, e.nFileSize);
+		ifs.close();
+
+		// Add To Map
+		mapFiles[sFile] = e;
+		return olc::OK;
+	}
+
+	olc::rcode ResourcePack::SavePack(std::string sFile)
+	{
+		std::ofstream ofs(sFile, std::ofstream::binary);
+		if (!ofs.is_open()) return olc::FAIL;
+
+		// 1) Write Map
+		size_t nMapSize = mapFiles.size();
+		ofs.write((char*)&nMapSize, sizeof(size_t));
+		for (auto &e : mapFiles)
 		{
-			if(p.a == 255)
-				return pDrawTarget->SetPixel(x, y, p);
+			size_t nPathSize = e.first.size();
+			ofs.write((char*)&nPathSize, sizeof(size_t));
+			ofs.write(e.first.c_str(), nPathSize);
+			ofs.write((char*)&e.second.nID, sizeof(uint32_t));
+			ofs.write((char*)&e.second.nFileSize, sizeof(uint32_t));
+			ofs.write((char*)&e.second.nFileOffset, sizeof(uint32_t));
 		}
 
-		if (nPixelMode == Pixel::ALPHA)
+		// 2) Write Data
+		std::streampos offset = ofs.tellp();
+		for (auto &e : mapFiles)
 		{
-			Pixel d = pDrawTarget->GetPixel(x, y);
-			float a = (float)(p.a / 255.0f) * fBlendFactor;
-			float c = 1.0f - a;
-			float r = a * (float)p.r + c * (float)d.r;
-			float g = a * (float)p.g + c * (float)d.g;
-			float b = a * (float)p.b + c * (float)d.b;
-			return pDrawTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b));
+			e.second.nFileOffset = (uint32_t)offset;
+			ofs.write((char*)e.second.data, e.second.nFileSize);
+			offset += e.second.nFileSize;
 		}
 
-		if (nPixelMode == Pixel::CUSTOM)
+		// 3) Rewrite Map (it has been updated with offsets now)
+		ofs.seekp(std::ios::beg);
+		ofs.write((char*)&nMapSize, sizeof(size_t));
+		for (auto &e : mapFiles)
 		{
-			return pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
+			size_t nPathSize = e.first.size();
+			ofs.write((char*)&nPathSize, sizeof(size_t));
+			ofs.write(e.first.c_str(), nPathSize);
+			ofs.write((char*)&e.second.nID, sizeof(uint32_t));
+			ofs.write((char*)&e.second.nFileSize, sizeof(uint32_t));
+			ofs.write((char*)&e.second.nFileOffset, sizeof(uint32_t));
 		}
+		ofs.close();
 
-		return false;
-	}
-
-	void PixelGameEngine::SetSubPixelOffset(float ox, float oy)
-	{
-		fSubPixelOffsetX = ox * fPixelX;
-		fSubPixelOffsetY = oy * fPixelY;
+		return olc::OK;
 	}
 
-	void PixelGameEngine::DrawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, uint32_t pattern)
+	olc::rcode ResourcePack::LoadPack(std::string sFile)
 	{
-		int x, y, dx, dy, dx1, dy1, px, py, xe, ye, i;
-		dx = x2 - x1; dy = y2 - y1;
+		std::ifstream ifs(sFile, std::ifstream::binary);
+		if (!ifs.is_open()) return olc::FAIL;
 
-		auto rol = [&](void)
+		// 1) Read Map
+		uint32_t nMapEntries;
+		ifs.read((char*)&nMapEntries, sizeof(uint32_t));
+		for (uint32_t i = 0; i < nMapEntries; i++)
+		{
+			uint32_t nFilePathSize = 0;
+			ifs.read((char*)&nFilePathSize, sizeof(uint32_t));
+
+			std::string sFileName(nFilePathSize, ' ');
+			for (uint32_t j = 0; j < nFilePathSize; j++)
+				sFileName[j] = ifs.get();
+
+			sEntry e;
+			e.data = nullptr;
+			ifs.read((char*)&e.nID, sizeof(uint32_t));
+			ifs.read((char*)&e.nFileSize, sizeof(uint32_t));
+			ifs.read((char*)&e.nFileOffset, sizeof(uint32_t));
+			mapFiles[sFileName] = e;
+		}
+
+		// 2) Read Data
+		for (auto &e : mapFiles)
+		{
+			e.second.data = new uint8_t[(uint32_t)e.second.nFileSize];
+			ifs.seekg(e.second.nFileOffset);
+			ifs.read((char*)e.second.data, e.second.nFileSize);
+			e.second._config();
+		}
+
+		ifs.close();
+		return olc::OK;
+	}
+
+	olc::ResourcePack::sEntry ResourcePack::GetStreamBuffer(std::string sFile)
+	{
+		return mapFiles[sFile];
+	}
+
+	olc::rcode ResourcePack::ClearPack()
+	{
+		for (auto &e : mapFiles)
+		{
+			if (e.second.data != nullptr)
+				delete[] e.second.data;
+		}
+
+		mapFiles.clear();
+		return olc::OK;
+	}
+
+	//==========================================================
+
+	// Span kernels - these work on whole rows of pixels that have already
+	// been clipped, so there are no bounds checks in here
+
+	// Copies the pixels of a row that are fully opaque, and leaves the rest
+	static inline void olc_MaskRow(Pixel *pDst, const Pixel *pSrc, int32_t n)
+	{
+		int32_t i = 0;
+#ifdef OLC_SIMD_AVX2
+		const __m256i vAlpha8 = _mm256_set1_epi32((int)0xFF000000);
+		for (; i + 8 <= n; i += 8)
+		{
+			__m256i s = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+			__m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(s, vAlpha8), vAlpha8);
+			int bits = _mm256_movemask_epi8(m);
+			if (bits == 0) continue;
+			if (bits == -1)	_mm256_storeu_si256((__m256i*)(pDst + i), s);
+			else			_mm256_maskstore_epi32((int*)(pDst + i), m, s);
+		}
+#endif
+#ifdef OLC_SIMD_SSE2
+		const __m128i vAlpha4 = _mm_set1_epi32((int)0xFF000000);
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+			__m128i m = _mm_cmpeq_epi32(_mm_and_si128(s, vAlpha4), vAlpha4);
+			int bits = _mm_movemask_epi8(m);
+			if (bits == 0) continue;
+			if (bits != 0xFFFF)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(pDst + i));
+				s = _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, d));
+			}
+			_mm_storeu_si128((__m128i*)(pDst + i), s);
+		}
+#endif
+		for (; i < n; i++)
+			if (pSrc[i].a == 255) pDst[i] = pSrc[i];
+	}
+
+	// x / 255 rounded to nearest, for x up to 255 * 255
+	static inline uint32_t olc_Div255(uint32_t x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	// Fixed point version of the ALPHA blend, nBlend is the blend factor * 255
+	static inline Pixel olc_BlendPixel(Pixel s, Pixel d, uint32_t nBlend)
+	{
+		uint32_t a = olc_Div255(s.a * nBlend);
+		uint32_t c = 255 - a;
+		return Pixel(
+			(uint8_t)olc_Div255(s.r * a + d.r * c),
+			(uint8_t)olc_Div255(s.g * a + d.g * c),
+			(uint8_t)olc_Div255(s.b * a + d.b * c));
+	}
+
+#ifdef OLC_SIMD_SSE2
+	// The same, on 16 bit lanes
+	static inline __m128i olc_Div255x8(__m128i x)
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	// Two pixels unpacked to 16 bit channels, a is the weight of s in each lane
+	static inline __m128i olc_Lerp2x16(__m128i s, __m128i d, __m128i a)
+	{
+		__m128i c = _mm_sub_epi16(_mm_set1_epi16(255), a);
+		return olc_Div255x8(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, c)));
+	}
+#endif
+
+#ifdef OLC_SIMD_AVX2
+	static inline __m256i olc_Div255x16(__m256i x)
+	{
+		x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+	}
+
+	static inline __m256i olc_Lerp4x16(__m256i s, __m256i d, __m256i a)
+	{
+		__m256i c = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+		return olc_Div255x16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, c)));
+	}
+#endif
+
+	// Composites a premultiplied pixel over another, the blend factor scales
+	// the whole source pixel first
+	static inline Pixel olc_PremulPixel(Pixel s, Pixel d, uint32_t nBlend)
+	{
+		if (nBlend != 255)
+			s = Pixel((uint8_t)olc_Div255(s.r * nBlend), (uint8_t)olc_Div255(s.g * nBlend),
+				(uint8_t)olc_Div255(s.b * nBlend), (uint8_t)olc_Div255(s.a * nBlend));
+		uint32_t c = 255 - s.a;
+		return Pixel(
+			(uint8_t)std::min(s.r + olc_Div255(d.r * c), 255u),
+			(uint8_t)std::min(s.g + olc_Div255(d.g * c), 255u),
+			(uint8_t)std::min(s.b + olc_Div255(d.b * c), 255u),
+			(uint8_t)std::min(s.a + olc_Div255(d.a * c), 255u));
+	}
+
+	static inline void olc_PremulRow(Pixel *pDst, const Pixel *pSrc, int32_t n, uint32_t nBlend)
+	{
+		int32_t i = 0;
+#ifdef OLC_SIMD_SSE2
+		{
+			const __m128i vZero = _mm_setzero_si128();
+			const __m128i vBlend = _mm_set1_epi16((short)nBlend);
+			const __m128i v255 = _mm_set1_epi16(255);
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(pDst + i));
+				__m128i sl = _mm_unpacklo_epi8(s, vZero), sh = _mm_unpackhi_epi8(s, vZero);
+				if (nBlend != 255)
+				{
+					sl = olc_Div255x8(_mm_mullo_epi16(sl, vBlend));
+					sh = olc_Div255x8(_mm_mullo_epi16(sh, vBlend));
+				}
+				__m128i cl = _mm_sub_epi16(v255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0xFF), 0xFF));
+				__m128i ch = _mm_sub_epi16(v255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0xFF), 0xFF));
+				__m128i dl = olc_Div255x8(_mm_mullo_epi16(_mm_unpacklo_epi8(d, vZero), cl));
+				__m128i dh = olc_Div255x8(_mm_mullo_epi16(_mm_unpackhi_epi8(d, vZero), ch));
+				__m128i r = _mm_packus_epi16(_mm_add_epi16(sl, dl), _mm_add_epi16(sh, dh));
+				_mm_storeu_si128((__m128i*)(pDst + i), r);
+			}
+		}
+#endif
+		for (; i < n; i++)
+			pDst[i] = olc_PremulPixel(pSrc[i], pDst[i], nBlend);
+	}
+
+	// Alpha blends a row of pixels onto another, weighting each by its own alpha
+	static inline void olc_AlphaRow(Pixel *pDst, const Pixel *pSrc, int32_t n, uint32_t nBlend)
+	{
+		int32_t i = 0;
+#ifdef OLC_SIMD_AVX2
+		{
+			const __m256i vZero = _mm256_setzero_si256();
+			const __m256i vBlend = _mm256_set1_epi16((short)nBlend);
+			const __m256i vOpaque = _mm256_set1_epi32((int)0xFF000000);
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+				__m256i d = _mm256_loadu_si256((const __m256i*)(pDst + i));
+				__m256i sl = _mm256_unpacklo_epi8(s, vZero), sh = _mm256_unpackhi_epi8(s, vZero);
+				__m256i dl = _mm256_unpacklo_epi8(d, vZero), dh = _mm256_unpackhi_epi8(d, vZero);
+				__m256i al = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sl, 0xFF), 0xFF);
+				__m256i ah = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sh, 0xFF), 0xFF);
+				al = olc_Div255x16(_mm256_mullo_epi16(al, vBlend));
+				ah = olc_Div255x16(_mm256_mullo_epi16(ah, vBlend));
+				__m256i r = _mm256_packus_epi16(olc_Lerp4x16(sl, dl, al), olc_Lerp4x16(sh, dh, ah));
+				_mm256_storeu_si256((__m256i*)(pDst + i), _mm256_or_si256(r, vOpaque));
+			}
+		}
+#endif
+#ifdef OLC_SIMD_SSE2
+		{
+			const __m128i vZero = _mm_setzero_si128();
+			const __m128i vBlend = _mm_set1_epi16((short)nBlend);
+			const __m128i vOpaque = _mm_set1_epi32((int)0xFF000000);
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(pDst + i));
+				__m128i sl = _mm_unpacklo_epi8(s, vZero), sh = _mm_unpackhi_epi8(s, vZero);
+				__m128i dl = _mm_unpacklo_epi8(d, vZero), dh = _mm_unpackhi_epi8(d, vZero);
+				__m128i al = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0xFF), 0xFF);
+				__m128i ah = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0xFF), 0xFF);
+				al = olc_Div255x8(_mm_mullo_epi16(al, vBlend));
+				ah = olc_Div255x8(_mm_mullo_epi16(ah, vBlend));
+				__m128i r = _mm_packus_epi16(olc_Lerp2x16(sl, dl, al), olc_Lerp2x16(sh, dh, ah));
+				_mm_storeu_si128((__m128i*)(pDst + i), _mm_or_si128(r, vOpaque));
+			}
+		}
+#endif
+		for (; i < n; i++)
+			pDst[i] = olc_BlendPixel(pSrc[i], pDst[i], nBlend);
+	}
+
+	// Alpha blends a single colour across a row of pixels
+	static inline void olc_BlendColourRow(Pixel *pDst, Pixel p, uint32_t nBlend, int32_t n)
+	{
+		uint32_t a = olc_Div255(p.a * nBlend);
+		uint32_t c = 255 - a;
+		uint32_t sr = p.r * a, sg = p.g * a, sb = p.b * a;
+		int32_t i = 0;
+#ifdef OLC_SIMD_SSE2
+		{
+			const __m128i vZero = _mm_setzero_si128();
+			const __m128i vSrc = _mm_set_epi16(0, (short)sb, (short)sg, (short)sr, 0, (short)sb, (short)sg, (short)sr);
+			const __m128i vC = _mm_set1_epi16((short)c);
+			const __m128i vOpaque = _mm_set1_epi32((int)0xFF000000);
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(pDst + i));
+				__m128i dl = _mm_mullo_epi16(_mm_unpacklo_epi8(d, vZero), vC);
+				__m128i dh = _mm_mullo_epi16(_mm_unpackhi_epi8(d, vZero), vC);
+				__m128i r = _mm_packus_epi16(olc_Div255x8(_mm_add_epi16(dl, vSrc)), olc_Div255x8(_mm_add_epi16(dh, vSrc)));
+				_mm_storeu_si128((__m128i*)(pDst + i), _mm_or_si128(r, vOpaque));
+			}
+		}
+#endif
+		for (; i < n; i++)
+		{
+			Pixel d = pDst[i];
+			pDst[i] = Pixel(
+				(uint8_t)olc_Div255(sr + d.r * c),
+				(uint8_t)olc_Div255(sg + d.g * c),
+				(uint8_t)olc_Div255(sb + d.b * c));
+		}
+	}
+
+	// Fills h rows of w pixels with one colour. Fills bigger than the cache use
+	// non-temporal stores, so they don't evict everything else on the way
+	static inline void olc_FillRows(Pixel *pDst, int32_t nStride, int32_t w, int32_t h, Pixel p)
+	{
+#ifdef OLC_SIMD_SSE2
+		const bool bStream = (size_t)w * h * sizeof(Pixel) >= 1024 * 1024;
+#endif
+		for (int32_t j = 0; j < h; j++, pDst += nStride)
+		{
+			int32_t i = 0;
+#if defined(OLC_SIMD_AVX2)
+			const __m256i v = _mm256_set1_epi32((int)p.n);
+			if (bStream)
+			{
+				for (; i < w && ((uintptr_t)(pDst + i) & 31); i++) pDst[i] = p;
+				for (; i + 8 <= w; i += 8) _mm256_stream_si256((__m256i*)(pDst + i), v);
+			}
+			else
+				for (; i + 8 <= w; i += 8) _mm256_storeu_si256((__m256i*)(pDst + i), v);
+#elif defined(OLC_SIMD_SSE2)
+			const __m128i v = _mm_set1_epi32((int)p.n);
+			if (bStream)
+			{
+				for (; i < w && ((uintptr_t)(pDst + i) & 15); i++) pDst[i] = p;
+				for (; i + 4 <= w; i += 4) _mm_stream_si128((__m128i*)(pDst + i), v);
+			}
+			else
+				for (; i + 4 <= w; i += 4) _mm_storeu_si128((__m128i*)(pDst + i), v);
+#endif
+			for (; i < w; i++) pDst[i] = p;
+		}
+#ifdef OLC_SIMD_SSE2
+		if (bStream) _mm_sfence();
+#endif
+	}
+
+	// Repeats each pixel of a row scale times
+	static inline void olc_ExpandRow(Pixel *pDst, const Pixel *pSrc, int32_t n, uint32_t scale)
+	{
+		int32_t i = 0;
+#ifdef OLC_SIMD_SSE2
+		if (scale == 2)
+		{
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+				_mm_storeu_si128((__m128i*)(pDst + i * 2), _mm_unpacklo_epi32(s, s));
+				_mm_storeu_si128((__m128i*)(pDst + i * 2 + 4), _mm_unpackhi_epi32(s, s));
+			}
+		}
+		else if (scale == 4)
+		{
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+				__m128i lo = _mm_unpacklo_epi32(s, s), hi = _mm_unpackhi_epi32(s, s);
+				_mm_storeu_si128((__m128i*)(pDst + i * 4), _mm_unpacklo_epi64(lo, lo));
+				_mm_storeu_si128((__m128i*)(pDst + i * 4 + 4), _mm_unpackhi_epi64(lo, lo));
+				_mm_storeu_si128((__m128i*)(pDst + i * 4 + 8), _mm_unpacklo_epi64(hi, hi));
+				_mm_storeu_si128((__m128i*)(pDst + i * 4 + 12), _mm_unpackhi_epi64(hi, hi));
+			}
+		}
+		else
+		{
+			for (; i < n; i++)
+			{
+				const __m128i s = _mm_set1_epi32((int)pSrc[i].n);
+				uint32_t k = 0;
+				for (; k + 4 <= scale; k += 4)
+					_mm_storeu_si128((__m128i*)(pDst + i * scale + k), s);
+				for (; k < scale; k++)
+					pDst[i * scale + k] = pSrc[i];
+			}
+		}
+#endif
+		for (; i < n; i++)
+			std::fill_n(pDst + i * scale, scale, pSrc[i]);
+	}
+
+	//==========================================================
+
+	// Rows the calling thread may draw to. Render workers only own their band
+	// while running queued draw calls, any other thread may draw anywhere
+	struct olc_RenderBand
+	{
+		int32_t y1 = INT32_MIN;
+		int32_t y2 = INT32_MAX;
+		bool bWorker = false;
+	};
+
+	static thread_local olc_RenderBand olc_tlsBand;
+
+	static inline bool olc_InBand(int32_t y)
+	{
+		return y >= olc_tlsBand.y1 && y < olc_tlsBand.y2;
+	}
+
+	static inline void olc_ClipToBand(int32_t &y1, int32_t &y2)
+	{
+		y1 = std::max(y1, olc_tlsBand.y1);
+		y2 = std::min(y2, olc_tlsBand.y2);
+	}
+
+	PixelGameEngine::PixelGameEngine()
+	{
+		sAppName = "Undefined";
+		olc::PGEX::pge = this;
+	}
+
+	olc::rcode PixelGameEngine::Construct(uint32_t screen_w, uint32_t screen_h, uint32_t pixel_w, uint32_t pixel_h, bool full_screen, bool vsync)
+	{
+		nScreenWidth = screen_w;
+		nScreenHeight = screen_h;
+		nPixelWidth = pixel_w;
+		nPixelHeight = pixel_h;
+		bFullScreen = full_screen;
+		bEnableVSYNC = vsync;
+
+		fPixelX = 2.0f / (float)(nScreenWidth);
+		fPixelY = 2.0f / (float)(nScreenHeight);
+
+		if (nPixelWidth == 0 || nPixelHeight == 0 || nScreenWidth == 0 || nScreenHeight == 0)
+			return olc::FAIL;
+
+#ifdef _WIN32
+#ifdef UNICODE
+#ifndef __MINGW32__
+		wsAppName = ConvertS2W(sAppName);
+#endif
+#endif
+#endif
+		// Load the default font sheet
+		olc_ConstructFontSheet();
+
+		// Create a sprite that represents the primary drawing target
+		pDefaultDrawTarget = new Sprite(nScreenWidth, nScreenHeight);
+		SetDrawTarget(nullptr);
+		return olc::OK;
+	}
+
+
+	void PixelGameEngine::SetScreenSize(int w, int h)
+	{
+		delete pDefaultDrawTarget;
+		nScreenWidth = w;
+		nScreenHeight = h;
+		pDefaultDrawTarget = new Sprite(nScreenWidth, nScreenHeight);
+		SetDrawTarget(nullptr);
+		InvalidateScrollingBackground();
+		MarkDirty(0, 0, nScreenWidth, nScreenHeight);
+		fPixelX = 2.0f / (float)(nScreenWidth);
+		fPixelY = 2.0f / (float)(nScreenHeight);
+
+		// Both buffers of the window are cleared by the next two frames, which
+		// may be shown from another thread
+		nClearWindow = 2;
+		olc_UpdateViewport();
+	}
+
+	olc::rcode PixelGameEngine::Start()
+	{
+		// Construct the window
+		if (!olc_WindowCreate())
+			return olc::FAIL;
+
+		// Load libraries required for PNG file interaction
+//#ifdef _WIN32
+//		// Windows use GDI+
+//		Gdiplus::GdiplusStartupInput startupInput;
+//		ULONG_PTR			token;
+//		Gdiplus::GdiplusStartup(&token, &startupInput, NULL);
+//#else
+//		// Linux use libpng
+//
+//#endif
+		// Start the thread
+		bAtomActive = true;
+		std::thread t = std::thread(&PixelGameEngine::EngineThread, this);
+
+#ifdef _WIN32
+		// Handle Windows Message Loop
+		MSG msg;
+		while (GetMessage(&msg, NULL, 0, 0) > 0)
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+#endif
+
+		// Wait for thread to be exited
+		t.join();
+		return olc::OK;
+	}
+
+	void PixelGameEngine::SetDrawTarget(Sprite *target)
+	{
+		FlushDrawing();
+		if (target)
+			pDrawTarget = target;
+		else
+			pDrawTarget = pDefaultDrawTarget;
+	}
+
+	Sprite* PixelGameEngine::GetDrawTarget()
+	{
+		return pDrawTarget;
+	}
+
+	int32_t PixelGameEngine::GetDrawTargetWidth()
+	{
+		if (pDrawTarget)
+			return pDrawTarget->width;
+		else
+			return 0;
+	}
+
+	int32_t PixelGameEngine::GetDrawTargetHeight()
+	{
+		if (pDrawTarget)
+			return pDrawTarget->height;
+		else
+			return 0;
+	}
+
+	bool PixelGameEngine::IsFocused()
+	{
+		return bHasInputFocus;
+	}
+
+	HWButton PixelGameEngine::GetKey(Key k)
+	{
+		return bInFixedUpdate ? pKeyTickState[k] : pKeyboardState[k];
+	}
+
+	HWButton PixelGameEngine::GetMouse(uint32_t b)
+	{
+		return bInFixedUpdate ? pMouseTickState[b] : pMouseState[b];
+	}
+
+	int32_t PixelGameEngine::GetMouseX()
+	{
+		return nMousePosX;
+	}
+
+	int32_t PixelGameEngine::GetMouseY()
+	{
+		return nMousePosY;
+	}
+
+	int32_t PixelGameEngine::GetMouseWheel()
+	{
+		return nMouseWheelDelta;
+	}
+
+	int32_t PixelGameEngine::ScreenWidth()
+	{
+		return nScreenWidth;
+	}
+
+	int32_t PixelGameEngine::ScreenHeight()
+	{
+		return nScreenHeight;
+	}
+
+	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
+	{
+		if (!pDrawTarget || !olc_InBand(y)) return false;
+		if (!vRenderCommands.empty()) olc_FlushCommands();
+		if (bDirtyRects) olc_MarkDirty(x, y, 1, 1);
+
+		if (nPixelMode == Pixel::NORMAL)
+		{
+			return pDrawTarget->SetPixel(x, y, p);
+		}
+
+		if (nPixelMode == Pixel::MASK)
+		{
+			if(p.a == 255)
+				return pDrawTarget->SetPixel(x, y, p);
+		}
+
+		if (nPixelMode == Pixel::ALPHA)
+		{
+			Pixel d = pDrawTarget->GetPixel(x, y);
+			return pDrawTarget->SetPixel(x, y, olc_BlendPixel(p, d, nBlendFactor));
+		}
+
+		if (nPixelMode == Pixel::CUSTOM)
+		{
+			return pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
+		}
+
+		if (nPixelMode == Pixel::PREMUL)
+		{
+			Pixel d = pDrawTarget->GetPixel(x, y);
+			return pDrawTarget->SetPixel(x, y, olc_PremulPixel(p, d, nBlendFactor));
+		}
+
+		return false;
+	}
+
+	void PixelGameEngine::SetSubPixelOffset(float ox, float oy)
+	{
+		fSubPixelOffsetX = ox * fPixelX;
+		fSubPixelOffsetY = oy * fPixelY;
+	}
+
+	void PixelGameEngine::DrawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Pixel p, uint32_t pattern)
+	{
+		if (olc_Defer(std::min(x1, x2), std::min(y1, y2), abs(x2 - x1) + 1, abs(y2 - y1) + 1, [=] { DrawLine(x1, y1, x2, y2, p, pattern); })) return;
+		int x, y, dx, dy, dx1, dy1, px, py;
+		dx = x2 - x1; dy = y2 - y1;
+		if (!pDrawTarget) return;
+		if (bDirtyRects) olc_MarkDirty(std::min(x1, x2), std::min(y1, y2), abs(dx) + 1, abs(dy) + 1);
+
+		auto rol = [&](void)
 		{
 			pattern = (pattern << 1) | (pattern >> 31);
 			return pattern & 1;
 		};
 
-		// straight lines idea by gurkanctn
-		if (dx == 0) // Line is vertical
+		// Starts the pattern k pixels into the line, as if they had been drawn
+		auto skip = [&](int64_t k)
+		{
+			uint32_t r = (uint32_t)(k % 32);
+			if (r) pattern = (pattern << r) | (pattern >> (32 - r));
+		};
+
+		auto FloorDiv = [](int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); };
+		auto CeilDiv = [&](int64_t a, int64_t b) { return -FloorDiv(-a, b); };
+
+		const int32_t W = pDrawTarget->width, H = pDrawTarget->height;
+
+		// straight lines idea by gurkanctn
+		if (dx == 0) // Line is vertical
+		{
+			if (y2 < y1) std::swap(y1, y2);
+			if (x1 < 0 || x1 >= W) return;
+			const int32_t ya = std::max(y1, 0), yb = std::min(y2, H - 1);
+			skip((int64_t)ya - y1);
+			for (y = ya; y <= yb; y++)
+				if (rol()) olc_DrawSpan(x1, y, 1, p);
+			return;
+		}
+
+		if (dy == 0) // Line is horizontal
+		{
+			if (x2 < x1) std::swap(x1, x2);
+			if (y1 < 0 || y1 >= H) return;
+			const int32_t xa = std::max(x1, 0), xb = std::min(x2, W - 1);
+			if (xa > xb) return;
+			if (pattern == 0xFFFFFFFF)
+			{
+				olc_DrawSpan(xa, y1, xb - xa + 1, p);
+				return;
+			}
+
+			// Draw the runs of set bits as spans
+			skip((int64_t)xa - x1);
+			for (x = xa; x <= xb;)
+			{
+				if (!rol()) { x++; continue; }
+				int32_t xs = x++;
+				while (x <= xb && rol()) x++;
+				olc_DrawSpan(xs, y1, x - xs, p);
+				x++;
+			}
+			return;
+		}
+
+		// Line is Funk-aye. Pixel k of the line steps k times along its major
+		// axis, and n(k) times along its minor axis, so the pixels that land on
+		// the draw target can be found up front and only those are stepped over
+		dx1 = abs(dx); dy1 = abs(dy);
+		const int s = ((dx < 0 && dy < 0) || (dx > 0 && dy > 0)) ? 1 : -1;
+		if (dy1 <= dx1)
+		{
+			// n(k) = floor((2k.dy1 + dx1) / 2dx1)
+			const int32_t xs = dx >= 0 ? x1 : x2, ys = dx >= 0 ? y1 : y2;
+			auto FirstK = [&](int64_t m) { return CeilDiv((2 * m - 1) * dx1, 2 * (int64_t)dy1); };
+			auto LastK = [&](int64_t m) { return CeilDiv((2 * m + 1) * dx1, 2 * (int64_t)dy1) - 1; };
+
+			int64_t k1 = std::max<int64_t>(0, -(int64_t)xs), k2 = std::min<int64_t>(dx1, (int64_t)W - 1 - xs);
+			if (s > 0) { k1 = std::max(k1, FirstK(-(int64_t)ys)); k2 = std::min(k2, LastK((int64_t)H - 1 - ys)); }
+			else       { k1 = std::max(k1, FirstK((int64_t)ys - (H - 1))); k2 = std::min(k2, LastK(ys)); }
+			if (k1 > k2) return;
+
+			const int64_t n = FloorDiv(2 * k1 * dy1 + dx1, 2 * (int64_t)dx1);
+			x = (int)(xs + k1); y = (int)(ys + s * n);
+			px = (int)(2 * (int64_t)dy1 - dx1 + 2 * k1 * dy1 - 2 * n * dx1);
+			skip(k1);
+
+			if (rol()) Draw(x, y, p);
+			for (int64_t k = k1; k < k2; k++)
+			{
+				x = x + 1;
+				if (px<0)
+					px = px + 2 * dy1;
+				else
+				{
+					y = y + s;
+					px = px + 2 * (dy1 - dx1);
+				}
+				if (rol()) Draw(x, y, p);
+			}
+		}
+		else
+		{
+			// n(k) = ceil((2k.dx1 - dy1) / 2dy1)
+			const int32_t xs = dy >= 0 ? x1 : x2, ys = dy >= 0 ? y1 : y2;
+			auto FirstK = [&](int64_t m) { return FloorDiv((2 * m - 1) * dy1, 2 * (int64_t)dx1) + 1; };
+			auto LastK = [&](int64_t m) { return FloorDiv((2 * m + 1) * dy1, 2 * (int64_t)dx1); };
+
+			int64_t k1 = std::max<int64_t>(0, -(int64_t)ys), k2 = std::min<int64_t>(dy1, (int64_t)H - 1 - ys);
+			if (s > 0) { k1 = std::max(k1, FirstK(-(int64_t)xs)); k2 = std::min(k2, LastK((int64_t)W - 1 - xs)); }
+			else       { k1 = std::max(k1, FirstK((int64_t)xs - (W - 1))); k2 = std::min(k2, LastK(xs)); }
+			if (k1 > k2) return;
+
+			const int64_t n = CeilDiv(2 * k1 * dx1 - dy1, 2 * (int64_t)dy1);
+			x = (int)(xs + s * n); y = (int)(ys + k1);
+			py = (int)(2 * (int64_t)dx1 - dy1 + 2 * k1 * dx1 - 2 * n * dy1);
+			skip(k1);
+
+			if (rol()) Draw(x, y, p);
+			for (int64_t k = k1; k < k2; k++)
+			{
+				y = y + 1;
+				if (py <= 0)
+					py = py + 2 * dx1;
+				else
+				{
+					x = x + s;
+					py = py + 2 * (dx1 - dy1);
+				}
+				if (rol()) Draw(x, y, p);
+			}
+		}
+	}
+
+	void PixelGameEngine::DrawCircle(int32_t x, int32_t y, int32_t radius, Pixel p, uint8_t mask)
+	{
+		if (olc_Defer(x - abs(radius), y - abs(radius), abs(radius) * 2 + 1, abs(radius) * 2 + 1, [=] { DrawCircle(x, y, radius, p, mask); })) return;
+		int x0 = 0;
+		int y0 = radius;
+		int d = 3 - 2 * radius;
+		if (!radius || !pDrawTarget) return;
+		if (x + radius < 0 || y + radius < 0 || x - radius >= pDrawTarget->width || y - radius >= pDrawTarget->height) return;
+		if (bDirtyRects) olc_MarkDirty(x - radius, y - radius, radius * 2 + 1, radius * 2 + 1);
+
+		while (y0 >= x0) // only formulate 1/8 of circle
+		{
+			if (mask & 0x01) Draw(x + x0, y - y0, p);
+			if (mask & 0x02) Draw(x + y0, y - x0, p);
+			if (mask & 0x04) Draw(x + y0, y + x0, p);
+			if (mask & 0x08) Draw(x + x0, y + y0, p);
+			if (mask & 0x10) Draw(x - x0, y + y0, p);
+			if (mask & 0x20) Draw(x - y0, y + x0, p);
+			if (mask & 0x40) Draw(x - y0, y - x0, p);
+			if (mask & 0x80) Draw(x - x0, y - y0, p);
+			if (d < 0) d += 4 * x0++ + 6;
+			else d += 4 * (x0++ - y0--) + 10;
+		}
+	}
+
+	void PixelGameEngine::FillCircle(int32_t x, int32_t y, int32_t radius, Pixel p)
+	{
+		if (olc_Defer(x - abs(radius), y - abs(radius), abs(radius) * 2 + 1, abs(radius) * 2 + 1, [=] { FillCircle(x, y, radius, p); })) return;
+		// Taken from wikipedia
+		int x0 = 0;
+		int y0 = radius;
+		int d = 3 - 2 * radius;
+		if (radius <= 0 || !pDrawTarget) return;
+		if (x + radius < 0 || y + radius < 0 || x - radius >= pDrawTarget->width || y - radius >= pDrawTarget->height) return;
+		if (bDirtyRects) olc_MarkDirty(x - radius, y - radius, radius * 2 + 1, radius * 2 + 1);
+
+		// The scan-lines overlap, so find the widest one for each row first
+		std::vector<int32_t> vHalfWidth(radius + 1, -1);
+		while (y0 >= x0)
+		{
+			vHalfWidth[y0] = std::max(vHalfWidth[y0], x0);
+			vHalfWidth[x0] = std::max(vHalfWidth[x0], y0);
+			if (d < 0) d += 4 * x0++ + 6;
+			else d += 4 * (x0++ - y0--) + 10;
+		}
+
+		// Then fill each row once, skipping those off the draw target
+		const int32_t r1 = std::max(-radius, -y), r2 = std::min(radius, pDrawTarget->height - 1 - y);
+		for (int32_t r = r1; r <= r2; r++)
+		{
+			const int32_t hw = vHalfWidth[abs(r)];
+			if (hw >= 0)
+				olc_DrawSpan(x - hw, y + r, hw * 2 + 1, p);
+		}
+	}
+
+	void PixelGameEngine::DrawRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	{
+		DrawLine(x, y, x+w, y, p);
+		DrawLine(x+w, y, x+w, y+h, p);
+		DrawLine(x+w, y+h, x, y+h, p);
+		DrawLine(x, y+h, x, y, p);
+	}
+
+	void PixelGameEngine::Clear(Pixel p)
+	{
+		if (olc_Defer(0, 0, GetDrawTargetWidth(), GetDrawTargetHeight(), [=] { Clear(p); }, nullptr, true)) return;
+
+		// The padding at the end of each row is filled too, so the whole array
+		// is done in one pass
+		Sprite *pTarget = GetDrawTarget();
+		int32_t y1 = 0, y2 = pTarget->height;
+		olc_ClipToBand(y1, y2);
+		if (y1 >= y2) return;
+		const int32_t pixels = pTarget->GetStride() * (y2 - y1);
+		olc_FillRows(pTarget->GetRow(y1), pixels, pixels, 1, p);
+		if (bDirtyRects) olc_MarkDirty(0, 0, GetDrawTargetWidth(), GetDrawTargetHeight());
+#ifdef OLC_DBG_OVERDRAW
+		olc::Sprite::nOverdrawCount += pixels;
+#endif
+	}
+
+	void PixelGameEngine::FillRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	{
+		if (!pDrawTarget) return;
+		if (olc_DeferFill(x, y, w, h, p)) return;
+
+		// Clip to the draw target, not the screen, so off-screen sprites work too
+		if (x < 0) { w += x; x = 0; }
+		if (y < 0) { h += y; y = 0; }
+		if (x + w > pDrawTarget->width) w = pDrawTarget->width - x;
+		if (y + h > pDrawTarget->height) h = pDrawTarget->height - y;
+		int32_t y2 = y + h;
+		olc_ClipToBand(y, y2);
+		h = y2 - y;
+		if (w <= 0 || h <= 0) return;
+
+		if (nPixelMode == Pixel::NORMAL || (nPixelMode == Pixel::MASK && p.a == 255))
+		{
+			if (bDirtyRects) olc_MarkDirty(x, y, w, h);
+			olc_FillRows(pDrawTarget->GetRow(y) + x, pDrawTarget->GetStride(), w, h, p);
+#ifdef OLC_DBG_OVERDRAW
+			olc::Sprite::nOverdrawCount += w * h;
+#endif
+		}
+		else
+		{
+			for (int32_t j = y; j < y + h; j++)
+				olc_DrawSpan(x, j, w, p);
+		}
+	}
+
+	void PixelGameEngine::DrawTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	{
+		DrawLine(x1, y1, x2, y2, p);
+		DrawLine(x2, y2, x3, y3, p);
+		DrawLine(x3, y3, x1, y1, p);
+	}
+
+	// https://www.avrfreaks.net/sites/default/files/triangles.c
+	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	{
+		const int32_t tx = std::min(x1, std::min(x2, x3)), ty = std::min(y1, std::min(y2, y3));
+		if (olc_Defer(tx, ty, std::max(x1, std::max(x2, x3)) + 1 - tx, std::max(y1, std::max(y2, y3)) + 1 - ty,
+			[=] { FillTriangle(x1, y1, x2, y2, x3, y3, p); })) return;
+		auto SWAP = [](int &x, int &y) { int t = x; x = y; y = t; };
+		auto drawline = [&](int sx, int ex, int ny) { olc_DrawSpan(sx, ny, ex - sx + 1, p); };
+		if (!pDrawTarget) return;
+
+		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
+		bool changed1 = false;
+		bool changed2 = false;
+		int signx1, signx2, dx1, dy1, dx2, dy2;
+		int e1, e2;
+		if (bDirtyRects)
+		{
+			int32_t minx = std::min(x1, std::min(x2, x3)), miny = std::min(y1, std::min(y2, y3));
+			olc_MarkDirty(minx, miny, std::max(x1, std::max(x2, x3)) - minx + 1, std::max(y1, std::max(y2, y3)) - miny + 1);
+		}
+
+		// Sort vertices
+		if (y1>y2) { SWAP(y1, y2); SWAP(x1, x2); }
+		if (y1>y3) { SWAP(y1, y3); SWAP(x1, x3); }
+		if (y2>y3) { SWAP(y2, y3); SWAP(x2, x3); }
+
+		// Nothing to do if the triangle is off the draw target, and rows are
+		// filled top down, so stop once they pass the bottom of it
+		if (y3 < 0 || y1 >= pDrawTarget->height) return;
+		if (std::max(x1, std::max(x2, x3)) < 0 || std::min(x1, std::min(x2, x3)) >= pDrawTarget->width) return;
+		const int32_t yEnd = pDrawTarget->height;
+
+		t1x = t2x = x1; y = y1;   // Starting points
+		dx1 = (int)(x2 - x1); if (dx1<0) { dx1 = -dx1; signx1 = -1; }
+		else signx1 = 1;
+		dy1 = (int)(y2 - y1);
+
+		dx2 = (int)(x3 - x1); if (dx2<0) { dx2 = -dx2; signx2 = -1; }
+		else signx2 = 1;
+		dy2 = (int)(y3 - y1);
+
+		if (dy1 > dx1) {   // swap values
+			SWAP(dx1, dy1);
+			changed1 = true;
+		}
+		if (dy2 > dx2) {   // swap values
+			SWAP(dy2, dx2);
+			changed2 = true;
+		}
+
+		e2 = (int)(dx2 >> 1);
+
+		// Rows above the target aren't walked, each edge is moved straight to
+		// where k rows of stepping would have left it, along with its step count
+		auto skip = [](int &x, int &e, int &i, int sign, int dx, int dy, bool changed, int64_t k) {
+			if (changed)
+			{
+				const int64_t t = e + k * dy;
+				x += sign * (int)(t / dx); e = (int)(t % dx); i += (int)k;
+			}
+			else
+			{
+				const int64_t s = (k * dx - e + dy - 1) / dy;
+				x += sign * (int)s; e = (int)(e + s * dy - k * dx); i += (int)s;
+			}
+		};
+		int i1 = 0, i2 = 0;
+
+		// Flat top, just process the second half
+		if (y1 == y2) goto next;
+		e1 = (int)(dx1 >> 1);
+		if (y < 0)
 		{
-			if (y2 < y1) std::swap(y1, y2);
-			for (y = y1; y <= y2; y++)
-				if (rol()) Draw(x1, y, p);
+			const int32_t k = std::min(y2, 0) - y;
+			if (y2 > 0) skip(t1x, e1, i1, signx1, dx1, dy1, changed1, k);
+			skip(t2x, e2, i2, signx2, dx2, dy2, changed2, k);
+			y += k;
+			if (y == y2) goto next;
+		}
+
+		for (int i = i1; i < dx1;) {
+			t1xp = 0; t2xp = 0;
+			if (t1x<t2x) { minx = t1x; maxx = t2x; }
+			else { minx = t2x; maxx = t1x; }
+			// process first line until y value is about to change
+			while (i<dx1) {
+				i++;
+				e1 += dy1;
+				while (e1 >= dx1) {
+					e1 -= dx1;
+					if (changed1) t1xp = signx1;//t1x += signx1;
+					else          goto next1;
+				}
+				if (changed1) break;
+				else t1x += signx1;
+			}
+			// Move line
+		next1:
+			// process second line until y value is about to change
+			while (1) {
+				e2 += dy2;
+				while (e2 >= dx2) {
+					e2 -= dx2;
+					if (changed2) t2xp = signx2;//t2x += signx2;
+					else          goto next2;
+				}
+				if (changed2)     break;
+				else              t2x += signx2;
+			}
+		next2:
+			if (minx>t1x) minx = t1x; if (minx>t2x) minx = t2x;
+			if (maxx<t1x) maxx = t1x; if (maxx<t2x) maxx = t2x;
+			drawline(minx, maxx, y);    // Draw line from min to max points found on the y
+										// Now increase y
+			if (!changed1) t1x += signx1;
+			t1x += t1xp;
+			if (!changed2) t2x += signx2;
+			t2x += t2xp;
+			y += 1;
+			if (y >= yEnd) return;
+			if (y == y2) break;
+
+		}
+	next:
+		// Second half
+		dx1 = (int)(x3 - x2); if (dx1<0) { dx1 = -dx1; signx1 = -1; }
+		else signx1 = 1;
+		dy1 = (int)(y3 - y2);
+		t1x = x2;
+
+		if (dy1 > dx1) {   // swap values
+			SWAP(dy1, dx1);
+			changed1 = true;
+		}
+		else changed1 = false;
+
+		e1 = (int)(dx1 >> 1);
+		i1 = 0;
+		if (y < 0)
+		{
+			skip(t1x, e1, i1, signx1, dx1, dy1, changed1, -y);
+			skip(t2x, e2, i2, signx2, dx2, dy2, changed2, -y);
+			y = 0;
+		}
+
+		for (int i = i1; i <= dx1; i++) {
+			t1xp = 0; t2xp = 0;
+			if (t1x<t2x) { minx = t1x; maxx = t2x; }
+			else { minx = t2x; maxx = t1x; }
+			// process first line until y value is about to change
+			while (i<dx1) {
+				e1 += dy1;
+				while (e1 >= dx1) {
+					e1 -= dx1;
+					if (changed1) { t1xp = signx1; break; }//t1x += signx1;
+					else          goto next3;
+				}
+				if (changed1) break;
+				else   	   	  t1x += signx1;
+				if (i<dx1) i++;
+			}
+		next3:
+			// process second line until y value is about to change
+			while (t2x != x3) {
+				e2 += dy2;
+				while (e2 >= dx2) {
+					e2 -= dx2;
+					if (changed2) t2xp = signx2;
+					else          goto next4;
+				}
+				if (changed2)     break;
+				else              t2x += signx2;
+			}
+		next4:
+
+			if (minx>t1x) minx = t1x; if (minx>t2x) minx = t2x;
+			if (maxx<t1x) maxx = t1x; if (maxx<t2x) maxx = t2x;
+			drawline(minx, maxx, y);
+			if (!changed1) t1x += signx1;
+			t1x += t1xp;
+			if (!changed2) t2x += signx2;
+			t2x += t2xp;
+			y += 1;
+			if (y>y3 || y >= yEnd) return;
+		}
+	}
+
+	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, Sprite *sprite, uint32_t scale)
+	{
+		if (sprite == nullptr)
+			return;
+
+		// Drawn onto itself, a sprite would read rows other bands are writing.
+		// In NORMAL mode a sprite overwrites everything under it
+		const int32_t s = (int32_t)std::max(scale, 1u);
+		const bool bCovers = nPixelMode == Pixel::NORMAL && sprite->GetSampleMode() == olc::Sprite::Mode::NORMAL;
+		if (sprite == pDrawTarget) FlushDrawing();
+		else if (olc_Defer(x, y, sprite->width * s, sprite->height * s, [=] { DrawSprite(x, y, sprite, scale); }, sprite, bCovers)) return;
+
+		if (scale > 1)
+			olc_BlitSpriteScaled(x, y, sprite, 0, 0, sprite->width, sprite->height, scale);
+		else
+			olc_BlitSprite(x, y, sprite, 0, 0, sprite->width, sprite->height);
+	}
+
+	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale)
+	{
+		if (sprite == nullptr)
+			return;
+		// The area is only covered if it lies within the sprite
+		const int32_t s = (int32_t)std::max(scale, 1u);
+		const bool bCovers = nPixelMode == Pixel::NORMAL && sprite->GetSampleMode() == olc::Sprite::Mode::NORMAL &&
+			ox >= 0 && oy >= 0 && ox + w <= sprite->width && oy + h <= sprite->height;
+		if (sprite == pDrawTarget) FlushDrawing();
+		else if (olc_Defer(x, y, w * s, h * s, [=] { DrawPartialSprite(x, y, sprite, ox, oy, w, h, scale); }, sprite, bCovers)) return;
+
+		if (scale > 1)
+			olc_BlitSpriteScaled(x, y, sprite, ox, oy, w, h, scale);
+		else
+			olc_BlitSprite(x, y, sprite, ox, oy, w, h);
+	}
+
+	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, const SpriteView &view)
+	{
+		if (view.GetSprite() == pDrawTarget) FlushDrawing();
+		else if (olc_Defer(x, y, view.width, view.height, [=] { olc_BlitView(x, y, view); }, view.GetSprite(), nPixelMode == Pixel::NORMAL)) return;
+		olc_BlitView(x, y, view);
+	}
+
+	void PixelGameEngine::DrawSpriteFiltered(float x, float y, Sprite *sprite, float scale)
+	{
+		if (sprite == nullptr)
+			return;
+		DrawPartialSpriteFiltered(x, y, sprite, 0, 0, sprite->width, sprite->height, scale);
+	}
+
+	void PixelGameEngine::DrawPartialSpriteFiltered(float x, float y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, float scale)
+	{
+		if (sprite == nullptr)
+			return;
+
+		// The area the scaled sprite can reach, kept within range of an int
+		const float fx1 = std::max(std::floor(x) - 1.0f, -1e9f), fx2 = std::min(std::ceil(x + w * scale) + 1.0f, 1e9f);
+		const float fy1 = std::max(std::floor(y) - 1.0f, -1e9f), fy2 = std::min(std::ceil(y + h * scale) + 1.0f, 1e9f);
+		if (sprite == pDrawTarget) FlushDrawing();
+		else if (olc_Defer((int32_t)fx1, (int32_t)fy1, (int32_t)(fx2 - fx1), (int32_t)(fy2 - fy1),
+			[=] { olc_BlitSpriteFiltered(x, y, sprite, ox, oy, w, h, scale); }, sprite)) return;
+
+		olc_BlitSpriteFiltered(x, y, sprite, ox, oy, w, h, scale);
+	}
+
+	void PixelGameEngine::olc_BlitSprite(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h)
+	{
+		if (!pDrawTarget) return;
+
+		// Periodic sprites wrap around, so the source can't be clipped as a
+		// rectangle - walk them in row order through Draw() instead
+		if (sprite->GetSampleMode() != olc::Sprite::Mode::NORMAL)
+		{
+			for (int32_t j = 0; j < h; j++)
+				for (int32_t i = 0; i < w; i++)
+					Draw(x + i, y + j, sprite->GetPixel(i + ox, j + oy));
 			return;
 		}
 
-		if (dy == 0) // Line is horizontal
+		// Clip the source area to the sprite, then draw it as a view
+		if (ox < 0) { x -= ox; w += ox; ox = 0; }
+		if (oy < 0) { y -= oy; h += oy; oy = 0; }
+		olc_BlitView(x, y, SpriteView(sprite, ox, oy, w, h));
+	}
+
+	void PixelGameEngine::olc_BlitView(int32_t x, int32_t y, const SpriteView &view)
+	{
+		if (!pDrawTarget || view.GetData() == nullptr) return;
+
+		// Clip the destination area to the draw target, and the rows this thread owns
+		int32_t ox = 0, oy = 0, w = view.width, h = view.height;
+		if (x < 0) { ox -= x; w += x; x = 0; }
+		if (y < 0) { oy -= y; h += y; y = 0; }
+		if (x + w > pDrawTarget->width) w = pDrawTarget->width - x;
+		if (y + h > pDrawTarget->height) h = pDrawTarget->height - y;
+		if (y < olc_tlsBand.y1) { oy += olc_tlsBand.y1 - y; h -= olc_tlsBand.y1 - y; y = olc_tlsBand.y1; }
+		if (y + h > olc_tlsBand.y2) h = olc_tlsBand.y2 - y;
+
+		if (w <= 0 || h <= 0) return;
+		if (bDirtyRects) olc_MarkDirty(x, y, w, h);
+
+		const Sprite *sprite = view.GetSprite();
+		const int32_t nSrcStride = view.GetStride();
+		const int32_t nDstStride = pDrawTarget->GetStride();
+		const Pixel *pSrc = view.GetRow(oy) + ox;
+		Pixel *pDst = pDrawTarget->GetRow(y) + x;
+
+#ifdef OLC_DBG_OVERDRAW
+		olc::Sprite::nOverdrawCount += w * h;
+#endif
+
+#ifdef OLC_DBG_BLIT
+		// Keep what was underneath so the result can be checked against Draw()
+		std::vector<Pixel> vUnder(w * h);
+		for (int32_t j = 0; j < h; j++)
+			memcpy(&vUnder[j * w], pDst + j * nDstStride, w * sizeof(Pixel));
+#endif
+
+		if (nPixelMode == Pixel::NORMAL && sprite == pDrawTarget)
 		{
-			if (x2 < x1) std::swap(x1, x2);
-			for (x = x1; x <= x2; x++)
-				if (rol()) Draw(x, y1, p);
+			// Rows may overlap if a sprite is drawn onto itself
+			for (int32_t j = 0; j < h; j++)
+				memmove(pDst + j * nDstStride, pSrc + j * nSrcStride, w * sizeof(Pixel));
+		}
+		else
+		{
+			for (int32_t j = 0; j < h; j++)
+				olc_DrawRow(pDst + j * nDstStride, pSrc + j * nSrcStride, w, x, y + j);
+		}
+
+#ifdef OLC_DBG_BLIT
+		if (sprite != pDrawTarget)
+			olc_DbgVerifyBlit(x, y, w, h, pSrc, nSrcStride, vUnder);
+#endif
+	}
+
+	void PixelGameEngine::olc_BlitSpriteScaled(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale)
+	{
+		if (!pDrawTarget) return;
+
+		if (sprite->GetSampleMode() != olc::Sprite::Mode::NORMAL)
+		{
+			for (int32_t j = 0; j < h; j++)
+				for (uint32_t js = 0; js < scale; js++)
+					for (int32_t i = 0; i < w; i++)
+						for (uint32_t is = 0; is < scale; is++)
+							Draw(x + (i*scale) + is, y + (j*scale) + js, sprite->GetPixel(i + ox, j + oy));
 			return;
 		}
 
-		// Line is Funk-aye
-		dx1 = abs(dx); dy1 = abs(dy);
-		px = 2 * dy1 - dx1;	py = 2 * dx1 - dy1;
-		if (dy1 <= dx1)
+		// Clip the source area to the sprite
+		const int32_t s = (int32_t)scale;
+		if (ox < 0) { x -= ox * s; w += ox; ox = 0; }
+		if (oy < 0) { y -= oy * s; h += oy; oy = 0; }
+		if (ox + w > sprite->width) w = sprite->width - ox;
+		if (oy + h > sprite->height) h = sprite->height - oy;
+		if (w <= 0 || h <= 0) return;
+
+		// Then the scaled area to the draw target, which can cut pixels in part
+		const int32_t dx1 = std::max(x, 0), dx2 = std::min(x + w * s, pDrawTarget->width);
+		int32_t dy1 = std::max(y, 0), dy2 = std::min(y + h * s, pDrawTarget->height);
+		olc_ClipToBand(dy1, dy2);
+		if (dx1 >= dx2 || dy1 >= dy2) return;
+		if (bDirtyRects) olc_MarkDirty(dx1, dy1, dx2 - dx1, dy2 - dy1);
+
+#ifdef OLC_DBG_OVERDRAW
+		olc::Sprite::nOverdrawCount += (dx2 - dx1) * (dy2 - dy1);
+#endif
+
+		// Source columns that land on the target, and where the first one starts
+		const int32_t sx1 = ox + (dx1 - x) / s, sx2 = ox + (dx2 - 1 - x) / s + 1;
+		const int32_t nSkip = (dx1 - x) - (sx1 - ox) * s;
+		const int32_t n = dx2 - dx1;
+
+		// A sprite drawn onto itself would overwrite rows it hasn't read yet
+		const Pixel *pSrc = sprite->GetData();
+		const int32_t nSrcStride = sprite->GetStride();
+		std::vector<Pixel> vCopy;
+		if (sprite == pDrawTarget)
+		{
+			vCopy.assign(pSrc, pSrc + nSrcStride * sprite->height);
+			pSrc = vCopy.data();
+		}
+
+		// One row buffer per render thread
+		static thread_local std::vector<Pixel> vScaleRow;
+		vScaleRow.resize((sx2 - sx1) * s);
+		for (int32_t sy = oy + (dy1 - y) / s; sy < oy + h; sy++)
+		{
+			const int32_t ry1 = std::max(y + (sy - oy) * s, dy1), ry2 = std::min(y + (sy - oy + 1) * s, dy2);
+			if (ry1 >= ry2) break;
+
+			// Expand the source row once, then lay it down for each of its scaled rows
+			olc_ExpandRow(vScaleRow.data(), pSrc + sy * nSrcStride + sx1, sx2 - sx1, scale);
+			for (int32_t ry = ry1; ry < ry2; ry++)
+				olc_DrawRow(pDrawTarget->GetRow(ry) + dx1, vScaleRow.data() + nSkip, n, dx1, ry);
+		}
+	}
+
+	void PixelGameEngine::olc_BlitSpriteFiltered(float x, float y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, float scale)
+	{
+		if (!pDrawTarget || scale <= 0.0f) return;
+
+		// The filter stays inside the source area, so clip it to the sprite first
+		if (ox < 0) { x -= ox * scale; w += ox; ox = 0; }
+		if (oy < 0) { y -= oy * scale; h += oy; oy = 0; }
+		if (ox + w > sprite->width) w = sprite->width - ox;
+		if (oy + h > sprite->height) h = sprite->height - oy;
+		if (w <= 0 || h <= 0) return;
+
+		// Pixels whose centres fall inside the scaled area
+		const int32_t dx1 = std::max((int32_t)std::ceil(x - 0.5f), 0);
+		int32_t dy1 = std::max((int32_t)std::ceil(y - 0.5f), 0);
+		const int32_t dx2 = std::min((int32_t)std::ceil(x + w * scale - 0.5f), pDrawTarget->width);
+		int32_t dy2 = std::min((int32_t)std::ceil(y + h * scale - 0.5f), pDrawTarget->height);
+		olc_ClipToBand(dy1, dy2);
+		if (dx1 >= dx2 || dy1 >= dy2) return;
+		if (bDirtyRects) olc_MarkDirty(dx1, dy1, dx2 - dx1, dy2 - dy1);
+
+#ifdef OLC_DBG_OVERDRAW
+		olc::Sprite::nOverdrawCount += (dx2 - dx1) * (dy2 - dy1);
+#endif
+
+		// A sprite drawn onto itself would overwrite rows it hasn't read yet
+		const Pixel *pSrc = sprite->GetData();
+		const int32_t nSrcStride = sprite->GetStride();
+		std::vector<Pixel> vCopy;
+		if (sprite == pDrawTarget)
+		{
+			vCopy.assign(pSrc, pSrc + nSrcStride * sprite->height);
+			pSrc = vCopy.data();
+		}
+
+		const bool bWrap = sprite->GetSampleMode() == olc::Sprite::Mode::PERIODIC;
+		const float fStep = 1.0f / scale, u = ox + (dx1 + 0.5f - x) * fStep;
+		const int32_t n = dx2 - dx1;
+		static thread_local std::vector<Pixel> vScaleRow;
+		vScaleRow.resize(n);
+		for (int32_t dy = dy1; dy < dy2; dy++)
+		{
+			olc_SampleRowBL(pSrc, nSrcStride, ox, oy, w, h, bWrap, u, oy + (dy + 0.5f - y) * fStep, fStep, 0.0f, vScaleRow.data(), n);
+			olc_DrawRow(pDrawTarget->GetRow(dy) + dx1, vScaleRow.data(), n, dx1, dy);
+		}
+	}
+
+	void PixelGameEngine::olc_DrawRow(Pixel *pDst, const Pixel *pSrc, int32_t n, int32_t x, int32_t y)
+	{
+		if (!olc_InBand(y)) return;
+		switch (nPixelMode)
+		{
+		case Pixel::NORMAL:	memcpy(pDst, pSrc, n * sizeof(Pixel));				break;
+		case Pixel::MASK:	olc_MaskRow(pDst, pSrc, n);							break;
+		case Pixel::ALPHA:	olc_AlphaRow(pDst, pSrc, n, nBlendFactor);			break;
+		case Pixel::PREMUL:	olc_PremulRow(pDst, pSrc, n, nBlendFactor);			break;
+		default:
+			// One call for the whole row, the blend function itself is inlined in there
+			funcPixelModeRow(x, y, pDst, pSrc, 1, n);
+			break;
+		}
+	}
+
+	void PGEX::DrawRow(int32_t x, int32_t y, const Pixel *pSrc, int32_t n)
+	{
+		if (n <= 0) return;
+		pge->FlushDrawing();
+		if (pge->bDirtyRects) pge->olc_MarkDirty(x, y, n, 1);
+#ifdef OLC_DBG_OVERDRAW
+		olc::Sprite::nOverdrawCount += n;
+#endif
+		Sprite *pTarget = pge->pDrawTarget;
+		pge->olc_DrawRow(pTarget->GetRow(y) + x, pSrc, n, x, y);
+	}
+
+	void PixelGameEngine::olc_DrawSpan(int32_t x, int32_t y, int32_t w, Pixel p)
+	{
+		if (!pDrawTarget || y < 0 || y >= pDrawTarget->height || !olc_InBand(y)) return;
+		if (x < 0) { w += x; x = 0; }
+		if (x + w > pDrawTarget->width) w = pDrawTarget->width - x;
+		if (w <= 0) return;
+		if (bDirtyRects) olc_MarkDirty(x, y, w, 1);
+
+		Pixel *pDst = pDrawTarget->GetRow(y) + x;
+
+#ifdef OLC_DBG_OVERDRAW
+		olc::Sprite::nOverdrawCount += w;
+#endif
+
+		if (nPixelMode == Pixel::NORMAL || (nPixelMode == Pixel::MASK && p.a == 255))
+			olc_FillRows(pDst, w, w, 1, p);
+		else if (nPixelMode == Pixel::ALPHA)
+			olc_BlendColourRow(pDst, p, nBlendFactor, w);
+		else if (nPixelMode == Pixel::PREMUL)
+			for (int32_t i = 0; i < w; i++)
+				pDst[i] = olc_PremulPixel(p, pDst[i], nBlendFactor);
+		else if (nPixelMode == Pixel::CUSTOM)
+			funcPixelModeRow(x, y, pDst, &p, 0, w);
+	}
+
+#ifdef OLC_DBG_BLIT
+	void PixelGameEngine::olc_DbgVerifyBlit(int32_t x, int32_t y, int32_t w, int32_t h, const Pixel *pSrc, int32_t nSrcStride, const std::vector<Pixel> &vUnder)
+	{
+		const int32_t nDstStride = pDrawTarget->GetStride();
+		Pixel *pDst = pDrawTarget->GetRow(y) + x;
+
+		// Swap the fast result out, and put back what was there before
+		std::vector<Pixel> vFast(w * h);
+		for (int32_t j = 0; j < h; j++)
+		{
+			memcpy(&vFast[j * w], pDst + j * nDstStride, w * sizeof(Pixel));
+			memcpy(pDst + j * nDstStride, &vUnder[j * w], w * sizeof(Pixel));
+		}
+
+		// Then draw the reference version one pixel at a time
+		int32_t nMismatch = 0;
+		for (int32_t j = 0; j < h; j++)
+			for (int32_t i = 0; i < w; i++)
+			{
+				Draw(x + i, y + j, pSrc[j * nSrcStride + i]);
+				if (pDst[j * nDstStride + i] != vFast[j * w + i])
+					nMismatch++;
+			}
+
+		if (nMismatch > 0)
+			std::cout << "Blit mismatch: " << nMismatch << " of " << w * h << " pixels differ from Draw() at ("
+				<< x << "," << y << ") mode " << (int)nPixelMode << "\n";
+	}
+#endif
+
+	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, CompiledSprite *sprite)
+	{
+		if (sprite == nullptr)
+			return;
+
+		DrawPartialSprite(x, y, sprite, 0, 0, sprite->width, sprite->height);
+	}
+
+	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, CompiledSprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h)
+	{
+		if (sprite == nullptr || !pDrawTarget)
+			return;
+		if (olc_Defer(x, y, w, h, [=] { DrawPartialSprite(x, y, sprite, ox, oy, w, h); }, sprite)) return;
+
+		// Same clipping as an ordinary sprite
+		if (ox < 0) { x -= ox; w += ox; ox = 0; }
+		if (oy < 0) { y -= oy; h += oy; oy = 0; }
+		if (ox + w > sprite->width) w = sprite->width - ox;
+		if (oy + h > sprite->height) h = sprite->height - oy;
+		if (x < 0) { ox -= x; w += x; x = 0; }
+		if (y < 0) { oy -= y; h += y; y = 0; }
+		if (x + w > pDrawTarget->width) w = pDrawTarget->width - x;
+		if (y + h > pDrawTarget->height) h = pDrawTarget->height - y;
+		if (y < olc_tlsBand.y1) { oy += olc_tlsBand.y1 - y; h -= olc_tlsBand.y1 - y; y = olc_tlsBand.y1; }
+		if (y + h > olc_tlsBand.y2) h = olc_tlsBand.y2 - y;
+		if (w <= 0 || h <= 0) return;
+		if (bDirtyRects) olc_MarkDirty(x, y, w, h);
+
+		// Opaque runs can be copied straight in unless the blend factor changes them
+		const bool bCopyOpaque = nPixelMode == Pixel::NORMAL || nPixelMode == Pixel::MASK ||
+			((nPixelMode == Pixel::ALPHA || nPixelMode == Pixel::PREMUL) && nBlendFactor == 255);
+		const int32_t ex = ox + w;
+
+		for (int32_t j = 0; j < h; j++)
 		{
-			if (dx >= 0)
-			{
-				x = x1; y = y1; xe = x2;
-			}
-			else
+			const int32_t sy = oy + j;
+			Pixel *pDstRow = pDrawTarget->GetRow(y + j) + x;
+			const Pixel *pSrc = sprite->vPixels.data() + sprite->vRowPixels[sy];
+			int32_t sx = 0;
+
+			for (uint32_t r = sprite->vRowRuns[sy]; r < sprite->vRowRuns[sy + 1] && sx < ex; r++)
 			{
-				x = x2; y = y2; xe = x1;
+				const CompiledSprite::sRun &run = sprite->vRuns[r];
+				sx += run.nSkip;
+
+				// Copy, then blend - clip each against the selected area
+				for (int32_t k = 0; k < 2; k++)
+				{
+					const int32_t n = k == 0 ? run.nCopy : run.nBlend;
+					const int32_t s1 = std::max(sx, ox), s2 = std::min(sx + n, ex);
+					if (s1 < s2)
+					{
+						if (k == 0 && bCopyOpaque)
+							memcpy(pDstRow + (s1 - ox), pSrc + (s1 - sx), (s2 - s1) * sizeof(Pixel));
+						else if (k == 1 && nPixelMode == Pixel::MASK)
+							;
+						else
+							olc_DrawRow(pDstRow + (s1 - ox), pSrc + (s1 - sx), s2 - s1, x + s1 - ox, y + j);
+#ifdef OLC_DBG_OVERDRAW
+						olc::Sprite::nOverdrawCount += s2 - s1;
+#endif
+					}
+					sx += n; pSrc += n;
+				}
 			}
+		}
+	}
 
-			if (rol()) Draw(x, y, p);
+	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, TiledSprite *sprite)
+	{
+		if (sprite == nullptr)
+			return;
+
+		DrawPartialSprite(x, y, sprite, 0, 0, sprite->width, sprite->height);
+	}
 
-			for (i = 0; x<xe; i++)
+	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, TiledSprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h)
+	{
+		if (sprite == nullptr || !pDrawTarget)
+			return;
+		if (olc_Defer(x, y, w, h, [=] { DrawPartialSprite(x, y, sprite, ox, oy, w, h); }, sprite)) return;
+
+		if (ox < 0) { x -= ox; w += ox; ox = 0; }
+		if (oy < 0) { y -= oy; h += oy; oy = 0; }
+		if (ox + w > sprite->width) w = sprite->width - ox;
+		if (oy + h > sprite->height) h = sprite->height - oy;
+		if (x < 0) { ox -= x; w += x; x = 0; }
+		if (y < 0) { oy -= y; h += y; y = 0; }
+		if (x + w > pDrawTarget->width) w = pDrawTarget->width - x;
+		if (y + h > pDrawTarget->height) h = pDrawTarget->height - y;
+		if (y < olc_tlsBand.y1) { oy += olc_tlsBand.y1 - y; h -= olc_tlsBand.y1 - y; y = olc_tlsBand.y1; }
+		if (y + h > olc_tlsBand.y2) h = olc_tlsBand.y2 - y;
+		if (w <= 0 || h <= 0) return;
+		if (bDirtyRects) olc_MarkDirty(x, y, w, h);
+
+		const int32_t T = sprite->nTileSize;
+		for (int32_t ty = oy / T; ty <= (oy + h - 1) / T; ty++)
+			for (int32_t tx = ox / T; tx <= (ox + w - 1) / T; tx++)
 			{
-				x = x + 1;
-				if (px<0)
-					px = px + 2 * dy1;
-				else
+				const TiledSprite::sTile &tile = sprite->vTiles[ty * sprite->nTilesX + tx];
+
+				// Transparent pixels leave the target alone when masking or blending,
+				// NORMAL copies them and CUSTOM functions see them as usual
+				if (tile.nKind == TiledSprite::EMPTY && (nPixelMode == Pixel::MASK ||
+					nPixelMode == Pixel::ALPHA || nPixelMode == Pixel::PREMUL))
+					continue;
+
+				// Part of the tile inside the selected area, in sprite space
+				const int32_t sx1 = std::max(tx * T, ox), sx2 = std::min(tx * T + T, ox + w);
+				const int32_t sy1 = std::max(ty * T, oy), sy2 = std::min(ty * T + T, oy + h);
+
+				for (int32_t sy = sy1; sy < sy2; sy++)
 				{
-					if ((dx<0 && dy<0) || (dx>0 && dy>0)) y = y + 1; else y = y - 1;
-					px = px + 2 * (dy1 - dx1);
+					const int32_t dx = x + sx1 - ox, dy = y + sy - oy;
+					if (tile.nKind == TiledSprite::STORED)
+					{
+						const Pixel *pSrc = &sprite->vTileset[(tile.nIndex * T + sy - ty * T) * T + sx1 - tx * T];
+						olc_DrawRow(pDrawTarget->GetRow(dy) + dx, pSrc, sx2 - sx1, dx, dy);
+#ifdef OLC_DBG_OVERDRAW
+						olc::Sprite::nOverdrawCount += sx2 - sx1;
+#endif
+					}
+					else
+						olc_DrawSpan(dx, dy, sx2 - sx1, tile.colour);
 				}
-				if (rol()) Draw(x, y, p);
 			}
-		}
-		else
+	}
+
+	void PixelGameEngine::DrawString(int32_t x, int32_t y, std::string sText, Pixel col, uint32_t scale)
+	{
+		Pixel::Mode m = nPixelMode;
+
+		// Mark the whole text block at once rather than glyph by glyph
+		int32_t w, h;
+		olc_TextExtent(sText, scale, w, h);
+		if (bDirtyRects) olc_MarkDirty(x, y, w, h);
+
+		// Only the glyphs are queued, the mode is switched on this thread
+		if(col.a != 255 || fBlendFactor < 1.0f)	SetPixelMode(Pixel::ALPHA);
+		else										SetPixelMode(Pixel::MASK);
+		if (!olc_Defer(x, y, w, h, [=] { olc_DrawGlyphs(x, y, sText, col, scale); }, fontSprite))
+			olc_DrawGlyphs(x, y, sText, col, scale);
+		SetPixelMode(m);
+	}
+
+	void PixelGameEngine::olc_TextExtent(const std::string &sText, uint32_t scale, int32_t &w, int32_t &h)
+	{
+		int32_t sx = 0;
+		w = 0; h = 8 * scale;
+		for (auto c : sText)
+			if (c == '\n') { sx = 0; h += 8 * scale; }
+			else { sx += 8 * scale; w = std::max(w, sx); }
+	}
+
+	void PixelGameEngine::olc_DrawGlyphs(int32_t x, int32_t y, const std::string &sText, Pixel col, uint32_t scale)
+	{
+		int32_t sx = 0;
+		int32_t sy = 0;
+		for (auto c : sText)
 		{
-			if (dy >= 0)
+			if (c == '\n')
 			{
-				x = x1; y = y1; ye = y2;
+				sx = 0; sy += 8 * scale;
 			}
 			else
 			{
-				x = x2; y = y2; ye = y1;
-			}
+				const uint8_t g = (uint8_t)c - 32;
+				const uint64_t nGlyph = g < 96 ? nFontGlyphs[g] : 0;
 
-			if (rol()) Draw(x, y, p);
-
-			for (i = 0; y<ye; i++)
-			{
-				y = y + 1;
-				if (py <= 0)
-					py = py + 2 * dx1;
-				else
+				// Draw each row of the glyph as runs of lit pixels, repeated for scale
+				for (uint32_t j = 0; j < 8; j++)
 				{
-					if ((dx<0 && dy<0) || (dx>0 && dy>0)) x = x + 1; else x = x - 1;
-					py = py + 2 * (dx1 - dy1);
+					uint32_t nRow = (uint32_t)(nGlyph >> (j * 8)) & 0xFF;
+					uint32_t i = 0;
+					while (nRow)
+					{
+						while (!(nRow & 1)) { nRow >>= 1; i++; }
+						uint32_t k = i;
+						while (nRow & 1) { nRow >>= 1; k++; }
+						for (uint32_t js = 0; js < scale; js++)
+							olc_DrawSpan(x + sx + i * scale, y + sy + j * scale + js, (k - i) * scale, col);
+						i = k;
+					}
 				}
-				if (rol()) Draw(x, y, p);
+				sx += 8 * scale;
 			}
 		}
 	}
 
-	void PixelGameEngine::DrawCircle(int32_t x, int32_t y, int32_t radius, Pixel p, uint8_t mask)
+	bool PixelGameEngine::UpdateTextLabel(TextLabel *label, const std::string &sText, Pixel col, uint32_t scale)
 	{
-		int x0 = 0;
-		int y0 = radius;
-		int d = 3 - 2 * radius;
-		if (!radius) return;
+		if (label == nullptr)
+			return false;
+		if (label->pSprite != nullptr && label->sText == sText && label->colour == col && label->nScale == scale)
+			return false;
 
-		while (y0 >= x0) // only formulate 1/8 of circle
-		{
-			if (mask & 0x01) Draw(x + x0, y - y0, p);
-			if (mask & 0x02) Draw(x + y0, y - x0, p);
-			if (mask & 0x04) Draw(x + y0, y + x0, p);
-			if (mask & 0x08) Draw(x + x0, y + y0, p);
-			if (mask & 0x10) Draw(x - x0, y + y0, p);
-			if (mask & 0x20) Draw(x - y0, y + x0, p);
-			if (mask & 0x40) Draw(x - y0, y - x0, p);
-			if (mask & 0x80) Draw(x - x0, y - y0, p);
-			if (d < 0) d += 4 * x0++ + 6;
-			else d += 4 * (x0++ - y0--) + 10;
-		}
+		// Queued draws may still read the old text
+		FlushDrawing();
+		label->sText = sText;
+		label->colour = col;
+		label->nScale = scale;
+		olc_TextExtent(sText, scale, label->width, label->height);
+
+		delete label->pSprite;
+		label->pSprite = new Sprite(std::max(label->width, 1), label->height);
+		std::fill_n(label->pSprite->GetData(), label->pSprite->GetStride() * label->pSprite->height, olc::BLANK);
+
+		// The glyphs are written as they are, blending happens when the label is drawn
+		Sprite *pTarget = pDrawTarget;
+		Pixel::Mode m = nPixelMode;
+		pDrawTarget = label->pSprite;
+		nPixelMode = Pixel::NORMAL;
+		olc_DrawGlyphs(0, 0, sText, col, scale);
+		nPixelMode = m;
+		pDrawTarget = pTarget;
+		return true;
 	}
 
-	void PixelGameEngine::FillCircle(int32_t x, int32_t y, int32_t radius, Pixel p)
+	void PixelGameEngine::DrawTextLabel(int32_t x, int32_t y, TextLabel *label)
 	{
-		// Taken from wikipedia
-		int x0 = 0;
-		int y0 = radius;
-		int d = 3 - 2 * radius;
-		if (!radius) return;
+		if (label == nullptr || label->pSprite == nullptr)
+			return;
 
-		auto drawline = [&](int sx, int ex, int ny)
-		{
-			for (int i = sx; i <= ex; i++)
-				Draw(i, ny, p);
-		};
+		Pixel::Mode m = nPixelMode;
+		if (label->colour.a != 255 || fBlendFactor < 1.0f)	SetPixelMode(Pixel::ALPHA);
+		else													SetPixelMode(Pixel::MASK);
+		Sprite *pSprite = label->pSprite;
+		const int32_t w = label->width, h = label->height;
+		if (!olc_Defer(x, y, w, h, [=] { olc_BlitSprite(x, y, pSprite, 0, 0, w, h); }, pSprite))
+			olc_BlitSprite(x, y, pSprite, 0, 0, w, h);
+		SetPixelMode(m);
+	}
 
-		while (y0 >= x0)
+	void PixelGameEngine::DrawScrollingBackground(Sprite *background, int32_t vx, int32_t vy)
+	{
+		if (background == nullptr || !pDrawTarget)
+			return;
+
+		// Scrolling moves rows between bands, so it is always drawn straight away
+		FlushDrawing();
+
+		// The background is opaque, so it is always copied as is
+		Pixel::Mode m = nPixelMode;
+		nPixelMode = Pixel::NORMAL;
+
+		const int32_t w = pDrawTarget->width;
+		const int32_t h = pDrawTarget->height;
+		int32_t dx = vx - nScrollX;
+		int32_t dy = vy - nScrollY;
+
+		if (!bScrollValid || background != pScrollBackground || pDrawTarget != pScrollTarget || abs(dx) >= w || abs(dy) >= h)
 		{
-			// Modified to draw scan-lines instead of edges
-			drawline(x - x0, x + x0, y - y0);
-			drawline(x - y0, x + y0, y - x0);
-			drawline(x - x0, x + x0, y + y0);
-			drawline(x - y0, x + y0, y + x0);
-			if (d < 0) d += 4 * x0++ + 6;
-			else d += 4 * (x0++ - y0--) + 10;
+			olc_BlitSprite(0, 0, background, vx, vy, w, h);
+		}
+		else
+		{
+			// Put back the background wherever something was drawn over it
+			for (auto &r : vScrollOverlays)
+				olc_BlitSprite(r.x, r.y, background, nScrollX + r.x, nScrollY + r.y, r.w, r.h);
+
+			if (dx != 0 || dy != 0)
+			{
+				// Shift the pixels that stay on screen, rows are walked away
+				// from the direction of travel so none is overwritten early
+				if (bDirtyRects) olc_MarkDirty(0, 0, w, h);
+				const int32_t sx = std::max(dx, 0), tx = std::max(-dx, 0), n = w - abs(dx);
+				if (dy >= 0)
+					for (int32_t y = 0; y < h - dy; y++)
+						memmove(pDrawTarget->GetRow(y) + tx, pDrawTarget->GetRow(y + dy) + sx, n * sizeof(Pixel));
+				else
+					for (int32_t y = h - 1; y >= -dy; y--)
+						memmove(pDrawTarget->GetRow(y) + tx, pDrawTarget->GetRow(y + dy) + sx, n * sizeof(Pixel));
+
+				// Then fill in the strips that have scrolled into view
+				if (dx > 0) olc_BlitSprite(w - dx, 0, background, vx + w - dx, vy, dx, h);
+				if (dx < 0) olc_BlitSprite(0, 0, background, vx, vy, -dx, h);
+				if (dy > 0) olc_BlitSprite(0, h - dy, background, vx, vy + h - dy, w, dy);
+				if (dy < 0) olc_BlitSprite(0, 0, background, vx, vy, w, -dy);
+			}
 		}
+
+		nPixelMode = m;
+		pScrollBackground = background;
+		pScrollTarget = pDrawTarget;
+		nScrollX = vx;
+		nScrollY = vy;
+		bScrollValid = true;
+		vScrollOverlays.clear();
 	}
 
-	void PixelGameEngine::DrawRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	void PixelGameEngine::AddScrollingOverlay(int32_t x, int32_t y, int32_t w, int32_t h)
 	{
-		DrawLine(x, y, x+w, y, p);
-		DrawLine(x+w, y, x+w, y+h, p);
-		DrawLine(x+w, y+h, x, y+h, p);
-		DrawLine(x, y+h, x, y, p);
+		vScrollOverlays.push_back({ x, y, w, h });
 	}
 
-	void PixelGameEngine::Clear(Pixel p)
+	void PixelGameEngine::InvalidateScrollingBackground()
 	{
-		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
-		Pixel* m = GetDrawTarget()->GetData();
-		for (int i = 0; i < pixels; i++)
-			m[i] = p;
-#ifdef OLC_DBG_OVERDRAW
-		olc::Sprite::nOverdrawCount += pixels;
-#endif
+		bScrollValid = false;
+		vScrollOverlays.clear();
 	}
 
-	void PixelGameEngine::FillRect(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	void PixelGameEngine::EnableDirtyRects(bool bEnable)
 	{
-		int32_t x2 = x + w;
-		int32_t y2 = y + h;
+		bDirtyRects = bEnable;
+		vDirtyRects.clear();
+		rDirtyLast = { 0, 0, 0, 0 };
 
-		if (x < 0) x = 0;
-		if (x >= (int32_t)nScreenWidth) x = (int32_t)nScreenWidth;
-		if (y < 0) y = 0;
-		if (y >= (int32_t)nScreenHeight) y = (int32_t)nScreenHeight;
+		// Whatever was on screen before hasn't been uploaded yet
+		if (bEnable) vDirtyRects.push_back({ 0, 0, (int32_t)nScreenWidth, (int32_t)nScreenHeight });
+	}
 
-		if (x2 < 0) x2 = 0;
-		if (x2 >= (int32_t)nScreenWidth) x2 = (int32_t)nScreenWidth;
-		if (y2 < 0) y2 = 0;
-		if (y2 >= (int32_t)nScreenHeight) y2 = (int32_t)nScreenHeight;
+	void PixelGameEngine::MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h)
+	{
+		Sprite *pTarget = pDrawTarget;
+		pDrawTarget = pDefaultDrawTarget;
+		olc_MarkDirty(x, y, w, h);
+		pDrawTarget = pTarget;
+	}
 
-		for (int i = x; i < x2; i++)
-			for (int j = y; j < y2; j++)
-				Draw(i, j, p);
+	void PixelGameEngine::SetDirtyRectOverlay(bool bShow)
+	{
+		bDirtyOverlay = bShow;
 	}
 
-	void PixelGameEngine::DrawTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	void PixelGameEngine::EnableParallelRendering(bool bEnable, int32_t nThreads)
 	{
-		DrawLine(x1, y1, x2, y2, p);
-		DrawLine(x2, y2, x3, y3, p);
-		DrawLine(x3, y3, x1, y1, p);
+		FlushDrawing();
+
+		// Stop any workers from before
+		{
+			std::lock_guard<std::mutex> lock(muxRender);
+			bRenderQuit = true;
+		}
+		cvRenderWork.notify_all();
+		for (auto &t : vRenderWorkers) t.join();
+		vRenderWorkers.clear();
+		bRenderQuit = false;
+
+		if (nThreads <= 0) nThreads = (int32_t)std::max(std::thread::hardware_concurrency(), 1u);
+		bParallelRender = bEnable && nThreads > 1;
+		if (!bParallelRender) return;
+
+		// The thread that flushes the queue draws bands too
+		for (int32_t i = 1; i < nThreads; i++)
+			vRenderWorkers.emplace_back(&PixelGameEngine::olc_RenderWorker, this);
 	}
 
-	// https://www.avrfreaks.net/sites/default/files/triangles.c
-	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
+	void PixelGameEngine::FlushDrawing()
 	{
-		auto SWAP = [](int &x, int &y) { int t = x; x = y; y = t; };
-		auto drawline = [&](int sx, int ex, int ny) { for (int i = sx; i <= ex; i++) Draw(i, ny, p); };
+		if (!vRenderCommands.empty()) olc_FlushCommands();
+	}
 
-		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
-		bool changed1 = false;
-		bool changed2 = false;
-		int signx1, signx2, dx1, dy1, dx2, dy2;
-		int e1, e2;
-		// Sort vertices
-		if (y1>y2) { SWAP(y1, y2); SWAP(x1, x2); }
-		if (y1>y3) { SWAP(y1, y3); SWAP(x1, x3); }
-		if (y2>y3) { SWAP(y2, y3); SWAP(x2, x3); }
+	void PixelGameEngine::EnableDeferredDrawing(bool bEnable)
+	{
+		FlushDrawing();
+		bDeferDraw = bEnable;
+	}
 
-		t1x = t2x = x1; y = y1;   // Starting points
-		dx1 = (int)(x2 - x1); if (dx1<0) { dx1 = -dx1; signx1 = -1; }
-		else signx1 = 1;
-		dy1 = (int)(y2 - y1);
+	void PixelGameEngine::GetDrawStats(uint32_t &nQueued, uint32_t &nDropped, uint32_t &nMerged)
+	{
+		nQueued = nLastDrawQueued;
+		nDropped = nLastDrawDropped;
+		nMerged = nLastDrawMerged;
+	}
 
-		dx2 = (int)(x3 - x1); if (dx2<0) { dx2 = -dx2; signx2 = -1; }
-		else signx2 = 1;
-		dy2 = (int)(y3 - y1);
+	bool PixelGameEngine::olc_Defer(int32_t x, int32_t y, int32_t w, int32_t h, std::function<void()> func, const void *pSource, bool bCovers)
+	{
+		return olc_QueueCommand({ { x, y, w, h }, Pixel::NORMAL, 1.0f, pSource, bCovers, false, Pixel(), std::move(func) });
+	}
 
-		if (dy1 > dx1) {   // swap values
-			SWAP(dx1, dy1);
-			changed1 = true;
-		}
-		if (dy2 > dx2) {   // swap values
-			SWAP(dy2, dx2);
-			changed2 = true;
+	bool PixelGameEngine::olc_DeferFill(int32_t x, int32_t y, int32_t w, int32_t h, Pixel p)
+	{
+		const bool bCovers = nPixelMode == Pixel::NORMAL || (nPixelMode == Pixel::MASK && p.a == 255);
+		return olc_QueueCommand({ { x, y, w, h }, Pixel::NORMAL, 1.0f, nullptr, bCovers, true, p, nullptr });
+	}
+
+	bool PixelGameEngine::olc_QueueCommand(sRenderCommand cmd)
+	{
+		if ((!bParallelRender && !bDeferDraw) || olc_tlsBand.bWorker) return false;
+
+		// Custom pixel modes may keep state, so they are never queued
+		if (!pDrawTarget || nPixelMode == Pixel::CUSTOM)
+		{
+			FlushDrawing();
+			return false;
 		}
 
-		e2 = (int)(dx2 >> 1);
-		// Flat top, just process the second half
-		if (y1 == y2) goto next;
-		e1 = (int)(dx1 >> 1);
+		sRect &r = cmd.rArea;
+		if (r.x < 0) { r.w += r.x; r.x = 0; }
+		if (r.y < 0) { r.h += r.y; r.y = 0; }
+		if (r.x + r.w > pDrawTarget->width) r.w = pDrawTarget->width - r.x;
+		if (r.y + r.h > pDrawTarget->height) r.h = pDrawTarget->height - r.y;
+		if (r.w <= 0 || r.h <= 0) return true;
+
+		if (bDirtyRects) olc_MarkDirty(r.x, r.y, r.w, r.h);
+		cmd.mode = nPixelMode;
+		cmd.fBlend = fBlendFactor;
+		vRenderCommands.push_back(std::move(cmd));
+		nDrawQueued++;
+		return true;
+	}
 
-		for (int i = 0; i < dx1;) {
-			t1xp = 0; t2xp = 0;
-			if (t1x<t2x) { minx = t1x; maxx = t2x; }
-			else { minx = t2x; maxx = t1x; }
-			// process first line until y value is about to change
-			while (i<dx1) {
-				i++;
-				e1 += dy1;
-				while (e1 >= dx1) {
-					e1 -= dx1;
-					if (changed1) t1xp = signx1;//t1x += signx1;
-					else          goto next1;
+	void PixelGameEngine::olc_OptimiseCommands()
+	{
+		auto Overlaps = [](const sRect &a, const sRect &b)
+		{ return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h; };
+		auto Contains = [](const sRect &a, const sRect &b)
+		{ return b.x >= a.x && b.y >= a.y && b.x + b.w <= a.x + a.w && b.y + b.h <= a.y + a.h; };
+
+		// Move each call back to the last one that draws the same thing in the
+		// same state, but only past calls it doesn't overlap, so nothing swaps
+		// where the order shows. Only a short way back is searched
+		vRenderOrder.clear();
+		for (uint32_t i = 0; i < vRenderCommands.size(); i++)
+		{
+			const sRenderCommand &c = vRenderCommands[i];
+			size_t at = vRenderOrder.size();
+			bool bMatch = false;
+			for (size_t k = vRenderOrder.size(); k > 0 && vRenderOrder.size() - k < 32; k--)
+			{
+				const sRenderCommand &o = vRenderCommands[vRenderOrder[k - 1]];
+				if (o.mode == c.mode && o.fBlend == c.fBlend && o.bFill == c.bFill && (c.bFill ? o.fill == c.fill : o.pSource == c.pSource))
+				{
+					at = k;
+					bMatch = true;
+					break;
 				}
-				if (changed1) break;
-				else t1x += signx1;
+				if (Overlaps(o.rArea, c.rArea)) break;
 			}
-			// Move line
-		next1:
-			// process second line until y value is about to change
-			while (1) {
-				e2 += dy2;
-				while (e2 >= dx2) {
-					e2 -= dx2;
-					if (changed2) t2xp = signx2;//t2x += signx2;
-					else          goto next2;
+
+			// Fills of one colour that share an edge become a single fill
+			if (bMatch && c.bFill)
+			{
+				sRect &a = vRenderCommands[vRenderOrder[at - 1]].rArea;
+				const sRect &b = c.rArea;
+				if (a.x == b.x && a.w == b.w && (a.y + a.h == b.y || b.y + b.h == a.y))
+				{
+					a.y = std::min(a.y, b.y); a.h += b.h;
+					nDrawMerged++;
+					continue;
+				}
+				if (a.y == b.y && a.h == b.h && (a.x + a.w == b.x || b.x + b.w == a.x))
+				{
+					a.x = std::min(a.x, b.x); a.w += b.w;
+					nDrawMerged++;
+					continue;
 				}
-				if (changed2)     break;
-				else              t2x += signx2;
 			}
-		next2:
-			if (minx>t1x) minx = t1x; if (minx>t2x) minx = t2x;
-			if (maxx<t1x) maxx = t1x; if (maxx<t2x) maxx = t2x;
-			drawline(minx, maxx, y);    // Draw line from min to max points found on the y
-										// Now increase y
-			if (!changed1) t1x += signx1;
-			t1x += t1xp;
-			if (!changed2) t2x += signx2;
-			t2x += t2xp;
-			y += 1;
-			if (y == y2) break;
+			vRenderOrder.insert(vRenderOrder.begin() + at, i);
+		}
+
+		// Walking back from the end, drop calls that lie entirely under a later
+		// one that covers its area. The largest covered areas are kept
+		sRect vCovers[8];
+		int32_t nCovers = 0;
+		size_t n = vRenderOrder.size();
+		for (size_t k = vRenderOrder.size(); k-- > 0;)
+		{
+			const sRenderCommand &c = vRenderCommands[vRenderOrder[k]];
+			if (std::any_of(vCovers, vCovers + nCovers, [&](const sRect &r) { return Contains(r, c.rArea); }))
+			{
+				vRenderOrder[k] = UINT32_MAX;
+				nDrawDropped++;
+				n--;
+				continue;
+			}
+			if (!c.bCovers) continue;
+			if (nCovers < 8) vCovers[nCovers++] = c.rArea;
+			else
+			{
+				sRect *pSmallest = std::min_element(vCovers, vCovers + nCovers,
+					[](const sRect &a, const sRect &b) { return a.w * a.h < b.w * b.h; });
+				if (pSmallest->w * pSmallest->h < c.rArea.w * c.rArea.h) *pSmallest = c.rArea;
+			}
+		}
+		if (n < vRenderOrder.size())
+			vRenderOrder.erase(std::remove(vRenderOrder.begin(), vRenderOrder.end(), UINT32_MAX), vRenderOrder.end());
+	}
+
+	void PixelGameEngine::olc_RunCommand(const sRenderCommand &cmd)
+	{
+		if (cmd.bFill) FillRect(cmd.rArea.x, cmd.rArea.y, cmd.rArea.w, cmd.rArea.h, cmd.fill);
+		else cmd.func();
+	}
 
+	void PixelGameEngine::olc_FlushCommands()
+	{
+		if (vRenderCommands.empty() || olc_tlsBand.bWorker) return;
+		olc_OptimiseCommands();
+
+		// Each call is run in the mode and blend it was made with
+		const Pixel::Mode mode = nPixelMode;
+		const float fBlend = fBlendFactor;
+		auto SetState = [&](Pixel::Mode m, float f)
+		{
+			nPixelMode = m;
+			fBlendFactor = f;
+			nBlendFactor = (uint32_t)(f * 255.0f + 0.5f);
+		};
+
+		if (vRenderWorkers.empty())
+		{
+			// On one thread the whole target is a single band
+			const olc_RenderBand band = olc_tlsBand;
+			olc_tlsBand.bWorker = true;
+			for (uint32_t i : vRenderOrder)
+			{
+				SetState(vRenderCommands[i].mode, vRenderCommands[i].fBlend);
+				olc_RunCommand(vRenderCommands[i]);
+			}
+			olc_tlsBand = band;
+		}
+		else
+		{
+			// The state can't change while bands are drawn, so each run of calls
+			// sharing one is drawn in bands of its own
+			for (size_t a = 0, b; a < vRenderOrder.size(); a = b)
+			{
+				const sRenderCommand &c = vRenderCommands[vRenderOrder[a]];
+				for (b = a + 1; b < vRenderOrder.size(); b++)
+					if (vRenderCommands[vRenderOrder[b]].mode != c.mode || vRenderCommands[vRenderOrder[b]].fBlend != c.fBlend) break;
+				SetState(c.mode, c.fBlend);
+				olc_RunBands(a, b);
+			}
 		}
-	next:
-		// Second half
-		dx1 = (int)(x3 - x2); if (dx1<0) { dx1 = -dx1; signx1 = -1; }
-		else signx1 = 1;
-		dy1 = (int)(y3 - y2);
-		t1x = x2;
 
-		if (dy1 > dx1) {   // swap values
-			SWAP(dy1, dx1);
-			changed1 = true;
+		SetState(mode, fBlend);
+		vRenderCommands.clear();
+	}
+
+	void PixelGameEngine::olc_RunBands(size_t a, size_t b)
+	{
+		{
+			// Wait for workers still leaving the last run before touching its state
+			std::unique_lock<std::mutex> lock(muxRender);
+			cvRenderDone.wait(lock, [&] { return nRenderActive == 0; });
+
+			// Several bands per thread, so one busy band doesn't hold up the rest.
+			// Each band keeps the calls that touch it in the order they are run
+			const int32_t nThreads = (int32_t)vRenderWorkers.size() + 1;
+			const int32_t H = pDrawTarget->height;
+			nRenderBandHeight = std::max(8, (H + nThreads * 4 - 1) / (nThreads * 4));
+			nRenderBands = (H + nRenderBandHeight - 1) / nRenderBandHeight;
+			vRenderBins.resize(nRenderBands);
+			for (auto &bin : vRenderBins) bin.clear();
+			for (size_t k = a; k < b; k++)
+			{
+				const sRect &r = vRenderCommands[vRenderOrder[k]].rArea;
+				for (int32_t band = r.y / nRenderBandHeight; band <= (r.y + r.h - 1) / nRenderBandHeight; band++)
+					vRenderBins[band].push_back(vRenderOrder[k]);
+			}
+
+			nNextRenderBand = 0;
+			nRenderBandsLeft = nRenderBands;
+			nRenderGeneration++;
 		}
-		else changed1 = false;
+		cvRenderWork.notify_all();
 
-		e1 = (int)(dx1 >> 1);
+		olc_RenderBands();
 
-		for (int i = 0; i <= dx1; i++) {
-			t1xp = 0; t2xp = 0;
-			if (t1x<t2x) { minx = t1x; maxx = t2x; }
-			else { minx = t2x; maxx = t1x; }
-			// process first line until y value is about to change
-			while (i<dx1) {
-				e1 += dy1;
-				while (e1 >= dx1) {
-					e1 -= dx1;
-					if (changed1) { t1xp = signx1; break; }//t1x += signx1;
-					else          goto next3;
-				}
-				if (changed1) break;
-				else   	   	  t1x += signx1;
-				if (i<dx1) i++;
+		std::unique_lock<std::mutex> lock(muxRender);
+		cvRenderDone.wait(lock, [&] { return nRenderBandsLeft == 0; });
+	}
+
+	void PixelGameEngine::olc_RenderBands()
+	{
+		const olc_RenderBand band = olc_tlsBand;
+		for (int32_t b = nNextRenderBand++; b < nRenderBands; b = nNextRenderBand++)
+		{
+			olc_tlsBand.y1 = b * nRenderBandHeight;
+			olc_tlsBand.y2 = olc_tlsBand.y1 + nRenderBandHeight;
+			olc_tlsBand.bWorker = true;
+			for (uint32_t i : vRenderBins[b])
+				olc_RunCommand(vRenderCommands[i]);
+
+			if (--nRenderBandsLeft == 0)
+			{
+				std::lock_guard<std::mutex> lock(muxRender);
+				cvRenderDone.notify_all();
 			}
-		next3:
-			// process second line until y value is about to change
-			while (t2x != x3) {
-				e2 += dy2;
-				while (e2 >= dx2) {
-					e2 -= dx2;
-					if (changed2) t2xp = signx2;
-					else          goto next4;
-				}
-				if (changed2)     break;
-				else              t2x += signx2;
+		}
+		olc_tlsBand = band;
+	}
+
+	void PixelGameEngine::olc_RenderWorker()
+	{
+		uint64_t nGeneration = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(muxRender);
+				cvRenderWork.wait(lock, [&] { return bRenderQuit || nRenderGeneration != nGeneration; });
+				if (bRenderQuit) return;
+				nGeneration = nRenderGeneration;
+				nRenderActive++;
 			}
-		next4:
 
-			if (minx>t1x) minx = t1x; if (minx>t2x) minx = t2x;
-			if (maxx<t1x) maxx = t1x; if (maxx<t2x) maxx = t2x;
-			drawline(minx, maxx, y);
-			if (!changed1) t1x += signx1;
-			t1x += t1xp;
-			if (!changed2) t2x += signx2;
-			t2x += t2xp;
-			y += 1;
-			if (y>y3) return;
+			olc_RenderBands();
+
+			{
+				std::lock_guard<std::mutex> lock(muxRender);
+				nRenderActive--;
+			}
+			cvRenderDone.notify_all();
 		}
 	}
 
-	void PixelGameEngine::DrawSprite(int32_t x, int32_t y, Sprite *sprite, uint32_t scale)
+	void PixelGameEngine::olc_MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h)
 	{
-		if (sprite == nullptr)
+		// Queued draw calls were marked when they were queued
+		if (olc_tlsBand.bWorker) return;
+		if (!bDirtyRects || pDrawTarget != pDefaultDrawTarget) return;
+
+		// Most calls land inside whatever was marked last, e.g. the pixels of a line
+		if (x >= rDirtyLast.x && y >= rDirtyLast.y && x + w <= rDirtyLast.x + rDirtyLast.w && y + h <= rDirtyLast.y + rDirtyLast.h)
 			return;
 
-		if (scale > 1)
+		if (x < 0) { w += x; x = 0; }
+		if (y < 0) { h += y; y = 0; }
+		if (x + w > pDrawTarget->width) w = pDrawTarget->width - x;
+		if (y + h > pDrawTarget->height) h = pDrawTarget->height - y;
+		if (w <= 0 || h <= 0) return;
+
+		auto Union = [](const sRect &a, const sRect &b)
 		{
-			for (int32_t i = 0; i < sprite->width; i++)
-				for (int32_t j = 0; j < sprite->height; j++)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i*scale) + is, y + (j*scale) + js, sprite->GetPixel(i, j));
+			int32_t x1 = std::min(a.x, b.x), y1 = std::min(a.y, b.y);
+			int32_t x2 = std::max(a.x + a.w, b.x + b.w), y2 = std::max(a.y + a.h, b.y + b.h);
+			return sRect{ x1, y1, x2 - x1, y2 - y1 };
+		};
+
+		// Absorb every rectangle this one overlaps or touches
+		sRect r = { x, y, w, h };
+		for (size_t i = 0; i < vDirtyRects.size();)
+		{
+			const sRect &d = vDirtyRects[i];
+			if (d.x <= r.x + r.w && r.x <= d.x + d.w && d.y <= r.y + r.h && r.y <= d.y + d.h)
+			{
+				r = Union(r, d);
+				vDirtyRects.erase(vDirtyRects.begin() + i);
+				i = 0;
+			}
+			else
+				i++;
 		}
-		else
+		vDirtyRects.push_back(r);
+
+		// Keep the list short by merging the pair that wastes the least area
+		const size_t nMaxDirtyRects = 16;
+		if (vDirtyRects.size() > nMaxDirtyRects)
+		{
+			size_t ba = 0, bb = 1;
+			int64_t nBest = INT64_MAX;
+			for (size_t a = 0; a < vDirtyRects.size(); a++)
+				for (size_t b = a + 1; b < vDirtyRects.size(); b++)
+				{
+					sRect u = Union(vDirtyRects[a], vDirtyRects[b]);
+					int64_t nWaste = (int64_t)u.w * u.h - (int64_t)vDirtyRects[a].w * vDirtyRects[a].h - (int64_t)vDirtyRects[b].w * vDirtyRects[b].h;
+					if (nWaste < nBest) { nBest = nWaste; ba = a; bb = b; }
+				}
+			vDirtyRects[ba] = Union(vDirtyRects[ba], vDirtyRects[bb]);
+			vDirtyRects.erase(vDirtyRects.begin() + bb);
+			r = vDirtyRects[ba];
+		}
+
+		rDirtyLast = r;
+	}
+
+	// Sorts row ranges and merges those that overlap or touch
+	static void olc_MergeRows(std::vector<std::pair<int32_t, int32_t>> &vRows)
+	{
+		std::sort(vRows.begin(), vRows.end());
+		size_t n = 0;
+		for (size_t i = 0; i < vRows.size(); i++)
+			if (n > 0 && vRows[i].first <= vRows[n - 1].second)
+				vRows[n - 1].second = std::max(vRows[n - 1].second, vRows[i].second);
+			else
+				vRows[n++] = vRows[i];
+		vRows.resize(n);
+	}
+
+	void PixelGameEngine::SetFixedUpdateRate(float fRate, uint32_t nMaxTicks)
+	{
+		fFixedTick = fRate > 0.0f ? 1.0f / fRate : 0.0f;
+		nMaxFixedTicks = std::max(nMaxTicks, 1u);
+		dFixedTime = 0.0;
+	}
+
+	bool PixelGameEngine::olc_RunFixedUpdates(float fElapsedTime, float &fAlpha)
+	{
+		fAlpha = 1.0f;
+		if (fFixedTick <= 0.0f) return true;
+
+		// Ticks due within a microsecond run now, or rounding in the frame times
+		// would keep putting them off to the next frame
+		dFixedTime += fElapsedTime;
+		bool bActive = true;
+		for (uint32_t nTicks = 0; bActive && dFixedTime >= fFixedTick - 1e-6; nTicks++)
 		{
-			for (int32_t i = 0; i < sprite->width; i++)
-				for (int32_t j = 0; j < sprite->height; j++)
-					Draw(x + i, y + j, sprite->GetPixel(i, j));
+			if (nTicks == nMaxFixedTicks)
+			{
+				dFixedTime = std::fmod(dFixedTime, (double)fFixedTick);
+				break;
+			}
+			dFixedTime -= fFixedTick;
+
+			// Each press and release is seen by exactly one tick
+			for (int i = 0; i < 256; i++)
+			{
+				pKeyTickState[i] = pKeyTickPending[i];
+				pKeyTickState[i].bHeld = pKeyboardState[i].bHeld;
+				pKeyTickPending[i] = HWButton();
+			}
+			for (int i = 0; i < 5; i++)
+			{
+				pMouseTickState[i] = pMouseTickPending[i];
+				pMouseTickState[i].bHeld = pMouseState[i].bHeld;
+				pMouseTickPending[i] = HWButton();
+			}
+
+			bInFixedUpdate = true;
+			bActive = OnUserFixedUpdate(fFixedTick);
+			bInFixedUpdate = false;
 		}
+
+		fAlpha = std::min(std::max((float)(dFixedTime / fFixedTick), 0.0f), 1.0f);
+		return bActive;
 	}
 
-	void PixelGameEngine::DrawPartialSprite(int32_t x, int32_t y, Sprite *sprite, int32_t ox, int32_t oy, int32_t w, int32_t h, uint32_t scale)
+	void PixelGameEngine::SetFrameRateLimit(float fFPS)
 	{
-		if (sprite == nullptr)
+		fFrameLimit = std::max(fFPS, 0.0f);
+		tpFrameDue = std::chrono::steady_clock::now();
+	}
+
+	void PixelGameEngine::GetFrameTiming(float &fMean, float &fJitter)
+	{
+		fMean = fFrameTimeMean;
+		fJitter = fFrameJitter;
+	}
+
+	void PixelGameEngine::olc_PaceFrame()
+	{
+		if (fFrameLimit <= 0.0f) return;
+		using clock = std::chrono::steady_clock;
+		const clock::duration tPeriod = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / fFrameLimit));
+
+		// Each frame is due a period after the last one was due, not after it
+		// started, so early and late frames don't shift the schedule. A frame
+		// more than a period late starts the schedule again rather than being
+		// followed by a burst of frames catching up
+		tpFrameDue += tPeriod;
+		clock::time_point tpNow = clock::now();
+		if (tpNow - tpFrameDue > tPeriod)
+		{
+			tpFrameDue = tpNow;
 			return;
+		}
 
-		if (scale > 1)
+		// Sleep until the OS should wake us just short of the deadline, allowing
+		// for how late sleeps have woken so far, then spin the rest of the way
+		const clock::duration tMargin = std::chrono::microseconds(200) + tOversleep;
+		if (tpFrameDue - tpNow > tMargin)
 		{
-			for (int32_t i = 0; i < w; i++)
-				for (int32_t j = 0; j < h; j++)
-					for (uint32_t is = 0; is < scale; is++)
-						for (uint32_t js = 0; js < scale; js++)
-							Draw(x + (i*scale) + is, y + (j*scale) + js, sprite->GetPixel(i + ox, j + oy));
+			const clock::time_point tpWake = tpFrameDue - tMargin;
+			std::this_thread::sleep_until(tpWake);
+			tOversleep += (clock::now() - tpWake - tOversleep) / 4;
+			tOversleep = std::min(std::max(tOversleep, clock::duration::zero()), tPeriod);
 		}
-		else
+		while (clock::now() < tpFrameDue)
+			std::this_thread::yield();
+	}
+
+	void PixelGameEngine::SetPresentBuffers(uint32_t nBuffers)
+	{
+		nPresentBuffers = std::min(std::max(nBuffers, 1u), 3u);
+	}
+
+	void PixelGameEngine::olc_PresentStart()
+	{
+		olc_OpenGLCreate();
+
+		// Create Screen Texture - disable filtering. It is sized by the first frame
+		glEnable(GL_TEXTURE_2D);
+		glGenTextures(1, &glBuffer);
+		glBindTexture(GL_TEXTURE_2D, glBuffer);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
+		nTextureWidth = nTextureHeight = 0;
+	}
+
+	void PixelGameEngine::olc_PresentStop()
+	{
+#ifdef _WIN32
+		wglDeleteContext(glRenderContext);
+#else
+		glXMakeCurrent(olc_Display, None, NULL);
+		glXDestroyContext(olc_Display, glDeviceContext);
+#endif
+	}
+
+	void PixelGameEngine::olc_DescribeFrame(sPresentFrame &f)
+	{
+		// Whole rows are uploaded, merging the row ranges of overlapping rectangles
+		f.vRows.clear();
+		if (bDirtyRects)
 		{
-			for (int32_t i = 0; i < w; i++)
-				for (int32_t j = 0; j < h; j++)
-					Draw(x + i, y + j, sprite->GetPixel(i + ox, j + oy));
+			for (auto &r : vDirtyRects)
+				f.vRows.push_back({ r.y, r.y + r.h });
+			olc_MergeRows(f.vRows);
 		}
+		else
+			f.vRows.push_back({ 0, pDefaultDrawTarget->height });
+
+		f.vOverlay.clear();
+		if (bDirtyRects && bDirtyOverlay) f.vOverlay = vDirtyRects;
+		f.nViewX = nViewX; f.nViewY = nViewY; f.nViewW = nViewW; f.nViewH = nViewH;
+		f.fPixelX = fPixelX; f.fPixelY = fPixelY;
+		f.fOffsetX = fSubPixelOffsetX; f.fOffsetY = fSubPixelOffsetY;
+		f.bClear = nClearWindow > 0;
+		if (nClearWindow > 0) nClearWindow--;
+
+		vDirtyRects.clear();
+		rDirtyLast = { 0, 0, 0, 0 };
 	}
 
-	void PixelGameEngine::DrawString(int32_t x, int32_t y, std::string sText, Pixel col, uint32_t scale)
+	void PixelGameEngine::olc_PresentFrame(Sprite *pScreen, const sPresentFrame &f)
 	{
-		int32_t sx = 0;
-		int32_t sy = 0;
-		Pixel::Mode m = nPixelMode;
-		if(col.ALPHA != 255)	SetPixelMode(Pixel::ALPHA);
-		else					SetPixelMode(Pixel::MASK);
-		for (auto c : sText)
+		// Rows are read straight out of the padded sprite
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, pScreen->GetStride());
+		if (pScreen->width != nTextureWidth || pScreen->height != nTextureHeight)
 		{
-			if (c == '\n')
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pScreen->width, pScreen->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pScreen->GetData());
+			nTextureWidth = pScreen->width;
+			nTextureHeight = pScreen->height;
+		}
+		else
+		{
+			for (auto &r : f.vRows)
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, r.first, pScreen->width, r.second - r.first, GL_RGBA, GL_UNSIGNED_BYTE, pScreen->GetRow(r.first));
+		}
+
+		glViewport(f.nViewX, f.nViewY, f.nViewW, f.nViewH);
+		if (f.bClear) glClear(GL_COLOR_BUFFER_BIT); // Thanks Benedani!
+
+		// Display texture on screen
+		glBegin(GL_QUADS);
+			glTexCoord2f(0.0, 1.0); glVertex3f(-1.0f + (f.fOffsetX), -1.0f + (f.fOffsetY), 0.0f);
+			glTexCoord2f(0.0, 0.0); glVertex3f(-1.0f + (f.fOffsetX),  1.0f + (f.fOffsetY), 0.0f);
+			glTexCoord2f(1.0, 0.0); glVertex3f( 1.0f + (f.fOffsetX),  1.0f + (f.fOffsetY), 0.0f);
+			glTexCoord2f(1.0, 1.0); glVertex3f( 1.0f + (f.fOffsetX), -1.0f + (f.fOffsetY), 0.0f);
+		glEnd();
+
+		// Outline what was uploaded this frame
+		if (!f.vOverlay.empty())
+		{
+			glDisable(GL_TEXTURE_2D);
+			glColor3f(1.0f, 0.0f, 1.0f);
+			for (auto &r : f.vOverlay)
 			{
-				sx = 0; sy += 8 * scale;
+				float x1 = -1.0f + f.fOffsetX + (r.x + 0.5f) * f.fPixelX, x2 = x1 + (r.w - 1) * f.fPixelX;
+				float y1 =  1.0f + f.fOffsetY - (r.y + 0.5f) * f.fPixelY, y2 = y1 - (r.h - 1) * f.fPixelY;
+				glBegin(GL_LINE_LOOP);
+					glVertex3f(x1, y1, 0.0f); glVertex3f(x2, y1, 0.0f);
+					glVertex3f(x2, y2, 0.0f); glVertex3f(x1, y2, 0.0f);
+				glEnd();
 			}
-			else
-			{
-				int32_t ox = (c - 32) % 16;
-				int32_t oy = (c - 32) / 16;
+			glColor3f(1.0f, 1.0f, 1.0f);
+			glEnable(GL_TEXTURE_2D);
+		}
 
-				if (scale > 1)
-				{
-					for (uint32_t i = 0; i < 8; i++)
-						for (uint32_t j = 0; j < 8; j++)
-							if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
-								for (uint32_t is = 0; is < scale; is++)
-									for (uint32_t js = 0; js < scale; js++)
-										Draw(x + sx + (i*scale) + is, y + sy + (j*scale) + js, col);
-				}
-				else
-				{
-					for (uint32_t i = 0; i < 8; i++)
-						for (uint32_t j = 0; j < 8; j++)
-							if (fontSprite->GetPixel(i + ox * 8, j + oy * 8).r > 0)
-								Draw(x + sx + i, y + sy + j, col);
-				}
-				sx += 8 * scale;
-			}
+		// Present Graphics to screen
+#ifdef _WIN32
+		SwapBuffers(glDeviceContext);
+#else
+		glXSwapBuffers(olc_Display, olc_Window);
+#endif
+	}
+
+	void PixelGameEngine::olc_SubmitFrame()
+	{
+		// Bound how far the game can run ahead of the window
+		const uint64_t nDepth = vPresentFrames.size();
+		olc_PresentWait([&] { return nFramesSubmitted - nFramesPresented < nDepth; });
+
+		// Swap the finished screen into the free frame, the draw target keeps
+		// its address but now holds the pixels of the frame shown nDepth ago
+		const uint64_t nFrame = nFramesSubmitted;
+		sPresentFrame &f = vPresentFrames[nFrame % nDepth];
+		olc_DescribeFrame(f);
+		std::swap(f.screen, *pDefaultDrawTarget);
+		vPresentHistory[nFrame % nDepth] = f.vRows;
+		nFramesSubmitted++;
+		olc_PresentNotify();
+
+		// Bring it up to date with the rows changed since, the presenter only
+		// reads the new frame meanwhile
+		Sprite *pScreen = pDefaultDrawTarget;
+		Sprite *pLatest = &f.screen;
+		if (pScreen->width != pLatest->width || pScreen->height != pLatest->height)
+		{
+			*pScreen = Sprite(pLatest->width, pLatest->height);
+			memcpy(pScreen->GetData(), pLatest->GetData(), pLatest->GetStride() * pLatest->height * sizeof(Pixel));
+			return;
 		}
-		SetPixelMode(m);
+
+		vPresentCopy.clear();
+		for (auto &vRows : vPresentHistory)
+			for (auto &r : vRows)
+				vPresentCopy.push_back({ std::max(r.first, 0), std::min(r.second, pScreen->height) });
+		olc_MergeRows(vPresentCopy);
+		for (auto &r : vPresentCopy)
+			if (r.first < r.second)
+				memcpy(pScreen->GetRow(r.first), pLatest->GetRow(r.first), pScreen->GetStride() * (r.second - r.first) * sizeof(Pixel));
+	}
+
+	PixelGameEngine::sPresentFrame* PixelGameEngine::olc_NextPresentFrame()
+	{
+		olc_PresentWait([&] { return bPresentQuit || nFramesPresented != nFramesSubmitted; });
+		if (nFramesPresented == nFramesSubmitted) return nullptr;
+		return &vPresentFrames[nFramesPresented % vPresentFrames.size()];
+	}
+
+	void PixelGameEngine::olc_FramePresented()
+	{
+		nFramesPresented++;
+		olc_PresentNotify();
+	}
+
+	void PixelGameEngine::olc_PresentThread()
+	{
+		olc_PresentStart();
+		while (sPresentFrame *f = olc_NextPresentFrame())
+		{
+			olc_PresentFrame(&f->screen, *f);
+			olc_FramePresented();
+		}
+		olc_PresentStop();
+	}
+
+	void PixelGameEngine::olc_PresentWait(const std::function<bool()> &ready)
+	{
+		if (ready()) return;
+
+		// Once counted as sleeping, the other side takes the mutex to wake us,
+		// so a change made just before can't be missed
+		std::unique_lock<std::mutex> lock(muxPresent);
+		nPresentSleepers++;
+		cvPresent.wait(lock, ready);
+		nPresentSleepers--;
+	}
+
+	void PixelGameEngine::olc_PresentNotify()
+	{
+		if (nPresentSleepers == 0) return;
+		std::lock_guard<std::mutex> lock(muxPresent);
+		cvPresent.notify_all();
 	}
 
 	void PixelGameEngine::SetPixelMode(Pixel::Mode m)
@@ -1680,8 +4239,7 @@ namespace olc
 
 	void PixelGameEngine::SetPixelMode(std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> pixelMode)
 	{
-		funcPixelMode = pixelMode;
-		nPixelMode = Pixel::Mode::CUSTOM;
+		SetPixelMode<std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)>>(pixelMode);
 	}
 
 	void PixelGameEngine::SetPixelBlend(float fBlend)
@@ -1689,6 +4247,7 @@ namespace olc
 		fBlendFactor = fBlend;
 		if (fBlendFactor < 0.0f) fBlendFactor = 0.0f;
 		if (fBlendFactor > 1.0f) fBlendFactor = 1.0f;
+		nBlendFactor = (uint32_t)(fBlendFactor * 255.0f + 0.5f);
 	}
 
 	// User must override these functions as required. I have not made
@@ -1698,6 +4257,10 @@ namespace olc
 	{ return false; }
 	bool PixelGameEngine::OnUserUpdate(float fElapsedTime)
 	{ return false; }
+	bool PixelGameEngine::OnUserFixedUpdate(float /*fTickTime*/)
+	{ return true; }
+	bool PixelGameEngine::OnUserRender(float fElapsedTime, float /*fAlpha*/)
+	{ return OnUserUpdate(fElapsedTime); }
 	bool PixelGameEngine::OnUserDestroy()
 	{ return true; }
 	//////////////////////////////////////////////////////////////////
@@ -1762,34 +4325,38 @@ namespace olc
 
 	void PixelGameEngine::EngineThread()
 	{
-		// Start OpenGL, the context is owned by the game thread
-		olc_OpenGLCreate();
-
-		// Create Screen Texture - disable filtering
-		glEnable(GL_TEXTURE_2D);
-		glGenTextures(1, &glBuffer);
-		glBindTexture(GL_TEXTURE_2D, glBuffer);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, nScreenWidth, nScreenHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pDefaultDrawTarget->GetData());
+		// Start OpenGL, the context is owned by the game thread unless frames
+		// are shown by a thread of their own
+		if (nPresentBuffers > 1)
+		{
+			// Until a frame has gone all the way round, every row is out of date
+			vPresentFrames.resize(nPresentBuffers - 1);
+			vPresentHistory.assign(nPresentBuffers - 1, { { 0, INT32_MAX } });
+			nFramesSubmitted = 0;
+			nFramesPresented = 0;
+			bPresentQuit = false;
+			tPresenter = std::thread(&PixelGameEngine::olc_PresentThread, this);
+		}
+		else
+			olc_PresentStart();
 
 
 		// Create user resources as part of this thread
 		if (!OnUserCreate())
 			bAtomActive = false;
 
-		auto tp1 = std::chrono::system_clock::now();
-		auto tp2 = std::chrono::system_clock::now();
+		auto tp1 = std::chrono::steady_clock::now();
+		auto tp2 = std::chrono::steady_clock::now();
+		tpFrameDue = tp1;
 
 		while (bAtomActive)
 		{
-			// Run as fast as possible
+			// Run as fast as possible, or as the frame rate limit allows
 			while (bAtomActive)
 			{
 				// Handle Timing
-				tp2 = std::chrono::system_clock::now();
+				olc_PaceFrame();
+				tp2 = std::chrono::steady_clock::now();
 				std::chrono::duration<float> elapsedTime = tp2 - tp1;
 				tp1 = tp2;
 
@@ -1811,7 +4378,7 @@ namespace olc
 						nWindowWidth = gwa.width;
 						nWindowHeight = gwa.height;
 						olc_UpdateViewport();
-						glClear(GL_COLOR_BUFFER_BIT); // Thanks Benedani!
+						nClearWindow = std::max(nClearWindow, 1);
 					}
 					else if (xev.type == ConfigureNotify)
 					{
@@ -1897,6 +4464,8 @@ namespace olc
 					}
 
 					pKeyOldState[i] = pKeyNewState[i];
+					pKeyTickPending[i].bPressed |= pKeyboardState[i].bPressed;
+					pKeyTickPending[i].bReleased |= pKeyboardState[i].bReleased;
 				}
 
 				// Handle User Input - Mouse
@@ -1920,6 +4489,8 @@ namespace olc
 					}
 
 					pMouseOldState[i] = pMouseNewState[i];
+					pMouseTickPending[i].bPressed |= pMouseState[i].bPressed;
+					pMouseTickPending[i].bReleased |= pMouseState[i].bReleased;
 				}
 
 				// Cache mouse coordinates so they remain
@@ -1935,39 +4506,48 @@ namespace olc
 #endif
 
 				// Handle Frame Update
-				if (!OnUserUpdate(fElapsedTime))
+				float fAlpha;
+				if (!olc_RunFixedUpdates(fElapsedTime, fAlpha))
+					bAtomActive = false;
+				else if (!OnUserRender(fElapsedTime, fAlpha))
 					bAtomActive = false;
+				FlushDrawing();
 
-				// Display Graphics
-				glViewport(nViewX, nViewY, nViewW, nViewH);
-
-				// TODO: This is a bit slow (especially in debug, but 100x faster in release mode???)
-				// Copy pixel array into texture
-				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, nScreenWidth, nScreenHeight, GL_RGBA, GL_UNSIGNED_BYTE, pDefaultDrawTarget->GetData());
-
-				// Display texture on screen
-				glBegin(GL_QUADS);
-					glTexCoord2f(0.0, 1.0); glVertex3f(-1.0f + (fSubPixelOffsetX), -1.0f + (fSubPixelOffsetY), 0.0f);
-					glTexCoord2f(0.0, 0.0); glVertex3f(-1.0f + (fSubPixelOffsetX),  1.0f + (fSubPixelOffsetY), 0.0f);
-					glTexCoord2f(1.0, 0.0); glVertex3f( 1.0f + (fSubPixelOffsetX),  1.0f + (fSubPixelOffsetY), 0.0f);
-					glTexCoord2f(1.0, 1.0); glVertex3f( 1.0f + (fSubPixelOffsetX), -1.0f + (fSubPixelOffsetY), 0.0f);
-				glEnd();
+				nLastDrawQueued = nDrawQueued;
+				nLastDrawDropped = nDrawDropped;
+				nLastDrawMerged = nDrawMerged;
+				nDrawQueued = nDrawDropped = nDrawMerged = 0;
 
-				// Present Graphics to screen
-#ifdef _WIN32
-				SwapBuffers(glDeviceContext);
-#else
-				glXSwapBuffers(olc_Display, olc_Window);
-#endif
+				// Display Graphics
+				if (nPresentBuffers > 1)
+					olc_SubmitFrame();
+				else
+				{
+					olc_DescribeFrame(frameDirect);
+					olc_PresentFrame(pDefaultDrawTarget, frameDirect);
+				}
 
 				// Update Title Bar
 				fFrameTimer += fElapsedTime;
 				nFrameCount++;
+				dFrameTimeSum += fElapsedTime;
+				dFrameTimeSqSum += (double)fElapsedTime * fElapsedTime;
 				if (fFrameTimer >= 1.0f)
 				{
 					fFrameTimer -= 1.0f;
 
+					const double dMean = dFrameTimeSum / nFrameCount;
+					fFrameTimeMean = (float)dMean;
+					fFrameJitter = (float)std::sqrt(std::max(dFrameTimeSqSum / nFrameCount - dMean * dMean, 0.0));
+					dFrameTimeSum = dFrameTimeSqSum = 0.0;
+
 					std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
+					if (fFrameLimit > 0.0f)
+					{
+						char sJitter[32];
+						snprintf(sJitter, sizeof(sJitter), " - Jitter: %.2fms", fFrameJitter * 1000.0f);
+						sTitle += sJitter;
+					}
 #ifdef _WIN32
 #ifdef UNICODE
 					SetWindowText(olc_hWnd, ConvertS2W(sTitle).c_str());
@@ -1993,12 +4573,21 @@ namespace olc
 			}
 		}
 
+		EnableParallelRendering(false);
+
+		// The presenter shows what is left, then lets go of OpenGL
+		if (tPresenter.joinable())
+		{
+			bPresentQuit = true;
+			olc_PresentNotify();
+			tPresenter.join();
+		}
+		else
+			olc_PresentStop();
+
 #ifdef _WIN32
-		wglDeleteContext(glRenderContext);
 		PostMessage(olc_hWnd, WM_DESTROY, 0, 0);
 #else
-		glXMakeCurrent(olc_Display, None, NULL);
-		glXDestroyContext(olc_Display, glDeviceContext);
 		XDestroyWindow(olc_Display, olc_Window);
 		XCloseDisplay(olc_Display);
 #endif
@@ -2055,6 +4644,7 @@ namespace olc
 			{
 				int k = r & (1 << i) ? 255 : 0;
 				fontSprite->SetPixel(px, py, olc::Pixel(k, k, k, k));
+				if (k) nFontGlyphs[(py / 8) * 16 + px / 8] |= 1ULL << ((py % 8) * 8 + px % 8);
 				if (++py == 48) { px++; py = 0; }
 			}
 		}
@@ -2341,7 +4931,7 @@ namespace olc
 	std::map<size_t, uint8_t> PixelGameEngine::mapKeys;
 	olc::PixelGameEngine* olc::PGEX::pge = nullptr;
 #ifdef OLC_DBG_OVERDRAW
-	int olc::Sprite::nOverdrawCount = 0;
+	std::atomic<int> olc::Sprite::nOverdrawCount(0);
 #endif
 	//=============================================================
 }